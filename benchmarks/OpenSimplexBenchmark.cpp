@@ -0,0 +1,422 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ * 
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+/*
+ * Measures the throughput of noise2/3/4 in ns per sample and prints the
+ * results as JSON, for spotting performance regressions.
+ *
+ * Inputs:
+ *   random  - points spread uniformly over a large area.
+ *   grid    - a raster sampled at 1/24 lattice units, as a texture would be.
+ *   worst   - random points restricted to the regions that visit the most
+ *             lattice vertices.
+ *
+ * Modes:
+ *   scalar  - Noise::noiseN once per point.
+ *   batch   - NoiseBatch::noiseNBatch over the whole array. maxUlp is the
+ *             largest difference from the scalar results (0 when exact).
+ *   grid    - Noise::fillGrid2/3 over the raster (grid input only).
+ *   compact - Noise::noiseN once per point through a CompactContext. maxUlp
+ *             is the largest difference from the scalar results (0 when
+ *             exact).
+ *   hash    - Noise::noiseN once per point through a HashContext, which
+ *             gives different values, so maxUlp is null.
+ *   hashBatch - NoiseBatch::noiseNBatch through the HashContext.
+ *   table   - Noise::noise3Table/noise4Table once per point, to compare
+ *             against the branch trees of noise3/4 (3D and 4D only).
+ *
+ * Each measurement runs single-threaded and, given more than one hardware
+ * thread, spread over a TileEngine. Build in release mode
+ * (-DCMAKE_BUILD_TYPE=Release); "optimized" in the output says whether it was.
+ *
+ * maxUlp is also null for the single-threaded scalar run, which is the
+ * reference itself.
+ *
+ * Usage: OpenSimplexBenchmark [--samples N] [--repeats N] [--threads N]
+ * Anything else, including an option without a value, prints the usage and
+ * exits with status 1.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "OpenSimplex/OpenSimplex.h"
+#include "OpenSimplex/TileEngine.h"
+
+struct Points
+{
+    std::vector<float> x, y, z, w;
+};
+
+struct Result
+{
+    std::string function;
+    std::string input;
+    std::string mode;
+    unsigned threads;
+    double bestNs;
+    double medianNs;
+    double checksum;
+    bool compared;
+    long long maxUlp;
+};
+
+static const float gridStep = 1.0f / 24;
+static const int gridWidth = 1024;
+static const int chunkSize = 4096;
+
+/* Made from the same seed as the Context passed around below. */
+static OpenSimplex::CompactContext compactContext;
+static OpenSimplex::HashContext hashContext;
+
+/* Numbers from unoptimized builds say little, so the output flags them. */
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && defined(NDEBUG))
+static const bool optimized = true;
+#else
+static const bool optimized = false;
+#endif
+
+static const char* instructionSetName(OpenSimplex::Dispatch::InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+        case OpenSimplex::Dispatch::InstructionSet::SSE2: return "SSE2";
+        case OpenSimplex::Dispatch::InstructionSet::SSE41: return "SSE4.1";
+        case OpenSimplex::Dispatch::InstructionSet::AVX2: return "AVX2";
+        case OpenSimplex::Dispatch::InstructionSet::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+/* Stretches a point onto the lattice and returns the sum of its coordinates within its super-cell. */
+static float inSum(const float* p, int dims)
+{
+    const float stretch[5] = { 0, 0, -0.211324865405187f, -1.0f / 6.0f, -0.138196601125011f };
+
+    float offset = 0;
+    for (int i = 0; i < dims; i++)
+        offset += p[i];
+    offset *= stretch[dims];
+
+    float sum = 0;
+    for (int i = 0; i < dims; i++) {
+        float s = p[i] + offset;
+        sum += s - std::floor(s);
+    }
+    return sum;
+}
+
+/* Whether a point lies in one of the regions that evaluate the most vertices. */
+static bool isWorstCase(const float* p, int dims)
+{
+    float sum = inSum(p, dims);
+    if (dims == 2)
+        return sum > 1;
+    if (dims == 3)
+        return sum > 1 && sum < 2;
+    return sum > 1 && sum < 3;
+}
+
+static Points makePoints(const std::string& input, int dims, size_t count)
+{
+    Points points;
+    points.x.resize(count);
+    points.y.resize(count);
+    points.z.resize(count);
+    points.w.resize(count);
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+
+    for (size_t i = 0; i < count; i++) {
+        float p[4];
+        if (input == "grid") {
+            size_t row = i / gridWidth;
+            p[0] = (i % gridWidth) * gridStep;
+            p[1] = (dims == 2 ? row : row % gridWidth) * gridStep;
+            p[2] = (dims == 2 ? 0 : row / gridWidth) * gridStep;
+            p[3] = 0.5f;
+        } else {
+            do {
+                for (int d = 0; d < 4; d++)
+                    p[d] = coordinate(rng);
+            } while (input == "worst" && !isWorstCase(p, dims));
+        }
+        points.x[i] = p[0];
+        points.y[i] = p[1];
+        points.z[i] = p[2];
+        points.w[i] = p[3];
+    }
+
+    return points;
+}
+
+static void evaluateScalar(const OpenSimplex::Context& ctx, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        if (dims == 2)
+            out[i] = OpenSimplex::Noise::noise2(ctx, p.x[i], p.y[i]);
+        else if (dims == 3)
+            out[i] = OpenSimplex::Noise::noise3(ctx, p.x[i], p.y[i], p.z[i]);
+        else
+            out[i] = OpenSimplex::Noise::noise4(ctx, p.x[i], p.y[i], p.z[i], p.w[i]);
+    }
+}
+
+static void evaluateCompact(const OpenSimplex::Context&, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        if (dims == 2)
+            out[i] = OpenSimplex::Noise::noise2(compactContext, p.x[i], p.y[i]);
+        else if (dims == 3)
+            out[i] = OpenSimplex::Noise::noise3(compactContext, p.x[i], p.y[i], p.z[i]);
+        else
+            out[i] = OpenSimplex::Noise::noise4(compactContext, p.x[i], p.y[i], p.z[i], p.w[i]);
+    }
+}
+
+static void evaluateHash(const OpenSimplex::Context&, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        if (dims == 2)
+            out[i] = OpenSimplex::Noise::noise2(hashContext, p.x[i], p.y[i]);
+        else if (dims == 3)
+            out[i] = OpenSimplex::Noise::noise3(hashContext, p.x[i], p.y[i], p.z[i]);
+        else
+            out[i] = OpenSimplex::Noise::noise4(hashContext, p.x[i], p.y[i], p.z[i], p.w[i]);
+    }
+}
+
+static void evaluateHashBatch(const OpenSimplex::Context&, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    if (dims == 2)
+        OpenSimplex::NoiseBatch::noise2Batch(hashContext, &p.x[begin], &p.y[begin], out + begin, n);
+    else if (dims == 3)
+        OpenSimplex::NoiseBatch::noise3Batch(hashContext, &p.x[begin], &p.y[begin], &p.z[begin], out + begin, n);
+    else
+        OpenSimplex::NoiseBatch::noise4Batch(hashContext, &p.x[begin], &p.y[begin], &p.z[begin], &p.w[begin], out + begin, n);
+}
+
+static void evaluateTable(const OpenSimplex::Context& ctx, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        if (dims == 3)
+            out[i] = OpenSimplex::Noise::noise3Table(ctx, p.x[i], p.y[i], p.z[i]);
+        else
+            out[i] = OpenSimplex::Noise::noise4Table(ctx, p.x[i], p.y[i], p.z[i], p.w[i]);
+    }
+}
+
+static void evaluateBatch(const OpenSimplex::Context& ctx, int dims, const Points& p, float* out, size_t begin, size_t end)
+{
+    size_t n = end - begin;
+    if (dims == 2)
+        OpenSimplex::NoiseBatch::noise2Batch(ctx, &p.x[begin], &p.y[begin], out + begin, n);
+    else if (dims == 3)
+        OpenSimplex::NoiseBatch::noise3Batch(ctx, &p.x[begin], &p.y[begin], &p.z[begin], out + begin, n);
+    else
+        OpenSimplex::NoiseBatch::noise4Batch(ctx, &p.x[begin], &p.y[begin], &p.z[begin], &p.w[begin], out + begin, n);
+}
+
+/* Runs one pass over all points, in chunks shared out over the engine when there is one. */
+static void evaluate(const OpenSimplex::Context& ctx, OpenSimplex::TileEngine* engine, const std::string& mode,
+                     int dims, const Points& p, float* out)
+{
+    size_t count = p.x.size();
+
+    if (mode == "grid") {
+        int height = (int) (count / gridWidth);
+        if (dims == 2) {
+            if (engine)
+                engine->fill2(ctx, out, 0, 0, gridStep, gridStep, gridWidth, height);
+            else
+                OpenSimplex::Noise::fillGrid2(ctx, out, 0, 0, gridStep, gridStep, gridWidth, height);
+        } else {
+            int depth = height / gridWidth;
+            height = gridWidth;
+            if (engine)
+                engine->fill3(ctx, out, 0, 0, 0, gridStep, gridStep, gridStep, gridWidth, height, depth);
+            else
+                OpenSimplex::Noise::fillGrid3(ctx, out, 0, 0, 0, gridStep, gridStep, gridStep, gridWidth, height, depth);
+        }
+        return;
+    }
+
+    void (*function)(const OpenSimplex::Context&, int, const Points&, float*, size_t, size_t) =
+        mode == "batch" ? evaluateBatch :
+        mode == "compact" ? evaluateCompact : mode == "hash" ? evaluateHash :
+        mode == "hashBatch" ? evaluateHashBatch : mode == "table" ? evaluateTable : evaluateScalar;
+
+    if (!engine) {
+        function(ctx, dims, p, out, 0, count);
+        return;
+    }
+
+    int chunks = (int) ((count + chunkSize - 1) / chunkSize);
+    engine->parallelFor(chunks, [&](int chunk) {
+        size_t begin = (size_t) chunk * chunkSize;
+        size_t end = std::min(begin + chunkSize, count);
+        function(ctx, dims, p, out, begin, end);
+    });
+}
+
+static long long ulpDistance(float a, float b)
+{
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    long long la = ia < 0 ? (long long) INT32_MIN - ia : ia;
+    long long lb = ib < 0 ? (long long) INT32_MIN - ib : ib;
+    return la > lb ? la - lb : lb - la;
+}
+
+static Result measure(const OpenSimplex::Context& ctx, OpenSimplex::TileEngine* engine, const std::string& mode,
+                      const std::string& input, int dims, const Points& p, int repeats,
+                      const std::vector<float>& reference, std::vector<float>& out)
+{
+    size_t count = p.x.size();
+    std::vector<double> times;
+
+    evaluate(ctx, engine, mode, dims, p, out.data()); /* Warm up caches and dispatch. */
+    for (int r = 0; r < repeats; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        evaluate(ctx, engine, mode, dims, p, out.data());
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / count);
+    }
+    std::sort(times.begin(), times.end());
+
+    Result result;
+    result.function = "noise" + std::to_string(dims);
+    result.input = input;
+    result.mode = mode;
+    result.threads = engine ? engine->threadCount() : 1;
+    result.bestNs = times.front();
+    result.medianNs = times[times.size() / 2];
+    result.checksum = 0;
+    result.compared = !reference.empty();
+    result.maxUlp = 0;
+    for (size_t i = 0; i < count; i++) {
+        result.checksum += out[i];
+        if (!reference.empty())
+            result.maxUlp = std::max(result.maxUlp, ulpDistance(out[i], reference[i]));
+    }
+    return result;
+}
+
+/* Parses a whole non-negative decimal number, rejecting anything else. */
+static bool parseCount(const char* text, unsigned long long& value)
+{
+    if (*text < '0' || *text > '9')
+        return false;
+    char* end;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0';
+}
+
+int main(int argc, char* argv[])
+{
+    size_t samples = 1 << 20;
+    int repeats = 5;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; i += 2) {
+        unsigned long long value = 0;
+        bool valid = i + 1 < argc && parseCount(argv[i + 1], value);
+        if (valid && !strcmp(argv[i], "--samples"))
+            samples = (size_t) value;
+        else if (valid && !strcmp(argv[i], "--repeats"))
+            repeats = (int) std::min(std::max(value, 1ull), 1000000ull);
+        else if (valid && !strcmp(argv[i], "--threads"))
+            threads = (unsigned) std::min(value, 4096ull);
+        else {
+            fprintf(stderr, "Usage: %s [--samples N] [--repeats N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    /* Whole rows for 2D and whole slices for 3D, so that the grid modes cover every sample. */
+    size_t slice = (size_t) gridWidth * gridWidth;
+    samples = std::max(slice, samples / slice * slice);
+
+    OpenSimplex::Context context;
+    OpenSimplex::Seed::computeContextForSeed(context, 77374);
+    OpenSimplex::Seed::computeCompactContextForSeed(compactContext, 77374);
+    OpenSimplex::Seed::computeHashContextForSeed(hashContext, 77374);
+    OpenSimplex::TileEngine engine(threads);
+
+    const char* inputs[] = { "random", "grid", "worst" };
+    const char* modes[] = { "scalar", "batch", "grid", "compact", "hash", "hashBatch", "table" };
+    std::vector<Result> results;
+    std::vector<float> out(samples), reference, none;
+
+    for (int dims = 2; dims <= 4; dims++) {
+        for (const char* input : inputs) {
+            Points points = makePoints(input, dims, samples);
+            reference.clear();
+            for (const char* mode : modes) {
+                if (!strcmp(mode, "grid") && (strcmp(input, "grid") || dims == 4))
+                    continue;
+                if (!strcmp(mode, "table") && dims == 2)
+                    continue;
+                for (int parallel = 0; parallel < (engine.threadCount() > 1 ? 2 : 1); parallel++) {
+                    bool hashed = !strncmp(mode, "hash", 4);
+                    results.push_back(measure(context, parallel ? &engine : nullptr, mode, input, dims,
+                                              points, repeats, hashed ? none : reference, out));
+                    if (!strcmp(mode, "scalar") && !parallel)
+                        reference = out;
+                }
+            }
+        }
+    }
+
+    printf("{\n");
+    printf("  \"samples\": %zu,\n", samples);
+    printf("  \"repeats\": %d,\n", repeats);
+    printf("  \"threads\": %u,\n", engine.threadCount());
+    printf("  \"instructionSet\": \"%s\",\n", instructionSetName(OpenSimplex::Dispatch::instructionSet()));
+    printf("  \"optimized\": %s,\n", optimized ? "true" : "false");
+    printf("  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::string maxUlp = r.compared ? std::to_string(r.maxUlp) : "null";
+        printf("    { \"function\": \"%s\", \"input\": \"%s\", \"mode\": \"%s\", \"threads\": %u, "
+               "\"nsPerSample\": %.3f, \"medianNsPerSample\": %.3f, \"maxUlp\": %s, \"checksum\": %.6f }%s\n",
+               r.function.c_str(), r.input.c_str(), r.mode.c_str(), r.threads, r.bestNs, r.medianNs,
+               maxUlp.c_str(), r.checksum, i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n");
+    printf("}\n");
+
+    return 0;
+}
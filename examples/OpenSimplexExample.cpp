@@ -24,6 +24,7 @@
  * For more information, please refer to <http://unlicense.org>
  */
 
+#include <cstring>
 #include <vector>
 #include <fstream>
 
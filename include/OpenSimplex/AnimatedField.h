@@ -0,0 +1,122 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "AnimatedField shouldn't be running on the GPU - so don't try including it!"
+#endif
+
+#include <cstddef>
+#include <vector>
+
+#include "Context.h"
+#include "NoiseBatch.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * A fixed set of points at which noise3(x, y, t) is evaluated frame after
+ * frame, such as particles or the vertices of a mesh. The points are kept
+ * laid out as the arrays NoiseBatch reads, so a frame only broadcasts its
+ * time into a block on the stack and runs NoiseBatch::noise3Batch; nothing
+ * is placed or gathered per frame. The values are those of noise3Batch at
+ * the time given.
+ *
+ * Frames are given their absolute time rather than a step, so that frame n
+ * can be evaluated at startTime + n * frameTime exactly instead of at a sum
+ * of steps that drifts. evaluate is const, so threads can evaluate disjoint
+ * ranges of the points at once. The field keeps its own copy of the context.
+ * For points on a regular raster, Slice3 does the same without storing any
+ * coordinates.
+ */
+template <typename ContextType>
+class BasicAnimatedField
+{
+public:
+    static const size_t blockSize = 256;
+
+    inline BasicAnimatedField(const ContextType& context, const float* xs, const float* ys, size_t count);
+
+    inline size_t size() const;
+
+    inline void evaluate(float time, float* out) const;
+    inline void evaluate(float time, float* out, size_t begin, size_t end) const;
+
+private:
+    ContextType ctx;
+    std::vector<float> xs;
+    std::vector<float> ys;
+};
+
+typedef BasicAnimatedField<Context> AnimatedField;
+typedef BasicAnimatedField<HashContext> HashAnimatedField;
+
+/* A field of count points at (xs[i], ys[i]). */
+template <typename ContextType>
+BasicAnimatedField<ContextType>::BasicAnimatedField(const ContextType& context, const float* xs, const float* ys, size_t count)
+    : ctx(context), xs(xs, xs + count), ys(ys, ys + count)
+{
+}
+
+template <typename ContextType>
+size_t BasicAnimatedField<ContextType>::size() const
+{
+    return xs.size();
+}
+
+/* Writes the noise of point i at time to out[i]. */
+template <typename ContextType>
+void BasicAnimatedField<ContextType>::evaluate(float time, float* out) const
+{
+    evaluate(time, out, 0, xs.size());
+}
+
+/*
+ * Evaluates only the points [begin, end), writing to the same places in
+ * out as evaluate(time, out) would. An empty range is fine.
+ */
+template <typename ContextType>
+void BasicAnimatedField<ContextType>::evaluate(float time, float* out, size_t begin, size_t end) const
+{
+    float ts[blockSize];
+    for (size_t i = 0; i < blockSize; i++)
+        ts[i] = time;
+    for (size_t block = begin; block < end; block += blockSize) {
+        size_t count = end - block < blockSize ? end - block : blockSize;
+        NoiseBatch::noise3Batch(ctx, xs.data() + block, ys.data() + block, ts, out + block, count);
+    }
+}
+
+}
@@ -42,4 +42,28 @@ struct Context
     int16_t permGradIndex3D[256];
 };
 
+/*
+ * A Context with byte-sized tables, since every entry fits in a byte. At 512
+ * bytes it takes half the cache lines and uniform buffer space of a Context;
+ * see Seed::computeCompactContextForSeed.
+ */
+struct CompactContext
+{
+    uint8_t perm[256];
+    uint8_t permGradIndex3D[256];
+};
+
+/*
+ * Selects gradients with an integer hash of the lattice coordinates and a
+ * seed rather than with permutation tables, so evaluating noise through it
+ * reads no memory and SIMD code needs no gathers to hash. The noise has the
+ * same character as with a Context but different values, and repeats only
+ * every 2^32 lattice units. See HashLattice and
+ * Seed::computeHashContextForSeed.
+ */
+struct HashContext
+{
+    uint32_t seed;
+};
+
 }
@@ -0,0 +1,144 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "Dispatch detects CPU features - it has nothing to do on the GPU!"
+#endif
+
+#if OPENSIMPLEX_HAS_DISPATCH
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+namespace OpenSimplex
+{
+
+namespace Dispatch
+{
+    /*
+     * The instruction sets the batch kernels are written for, from least to
+     * most capable. Each one implies those before it.
+     */
+    enum class InstructionSet
+    {
+        Scalar,
+        SSE2,
+        SSE41,
+        AVX2,
+        AVX512
+    };
+
+    inline InstructionSet instructionSet();
+    inline InstructionSet detectInstructionSet();
+}
+
+/*
+ * The instruction set batch calls are routed to. Detected on first use and
+ * cached for the life of the process.
+ */
+Dispatch::InstructionSet Dispatch::instructionSet()
+{
+    static const InstructionSet detected = detectInstructionSet();
+    return detected;
+}
+
+/*
+ * Queries the CPU with cpuid. An instruction set only counts if the OS also
+ * saves the registers it uses across context switches, which xgetbv reports.
+ */
+Dispatch::InstructionSet Dispatch::detectInstructionSet()
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    unsigned int leaf1[4] = { 0, 0, 0, 0 };
+    unsigned int leaf7[4] = { 0, 0, 0, 0 };
+    unsigned int maxLeaf;
+
+#if defined(_MSC_VER)
+    int registers[4];
+    __cpuid(registers, 0);
+    maxLeaf = (unsigned int) registers[0];
+    __cpuid(registers, 1);
+    for (int i = 0; i < 4; i++)
+        leaf1[i] = (unsigned int) registers[i];
+    if (maxLeaf >= 7) {
+        __cpuidex(registers, 7, 0);
+        for (int i = 0; i < 4; i++)
+            leaf7[i] = (unsigned int) registers[i];
+    }
+#else
+    maxLeaf = __get_cpuid_max(0, nullptr);
+    if (maxLeaf >= 1)
+        __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]);
+    if (maxLeaf >= 7)
+        __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+#endif
+
+    const bool sse2 = (leaf1[3] & (1u << 26)) != 0;
+    const bool sse41 = (leaf1[2] & (1u << 19)) != 0;
+    const bool osxsave = (leaf1[2] & (1u << 27)) != 0;
+    const bool avx = (leaf1[2] & (1u << 28)) != 0;
+    const bool avx2 = (leaf7[1] & (1u << 5)) != 0;
+    const bool avx512f = (leaf7[1] & (1u << 16)) != 0;
+
+    /* XCR0 bits 1-2 are the SSE and AVX state, bits 5-7 the AVX-512 state. */
+    unsigned long long xcr0 = 0;
+    if (osxsave) {
+#if defined(_MSC_VER)
+        xcr0 = _xgetbv(0);
+#else
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        xcr0 = ((unsigned long long) edx << 32) | eax;
+#endif
+    }
+    const bool avxState = (xcr0 & 0x06) == 0x06;
+    const bool avx512State = (xcr0 & 0xE6) == 0xE6;
+
+    if (avx && avx2 && avx512f && avxState && avx512State)
+        return InstructionSet::AVX512;
+    if (avx && avx2 && avxState)
+        return InstructionSet::AVX2;
+    if (sse41)
+        return InstructionSet::SSE41;
+    if (sse2)
+        return InstructionSet::SSE2;
+#endif
+    return InstructionSet::Scalar;
+}
+
+}
@@ -50,3 +50,42 @@
 #else
     #define OPENSIMPLEX_GPU_CONSTANT
 #endif
+
+#if !OPENSIMPLEX_IS_GPU && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+    #define OPENSIMPLEX_IS_X86 1
+#else
+    #define OPENSIMPLEX_IS_X86 0
+#endif
+
+/*
+ * Marks functions that can run at compile time from C++14 on, where
+ * constexpr functions may contain loops and local state. Before that they
+ * are merely inline.
+ */
+#if (defined(__cplusplus) && __cplusplus >= 201402L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+    #define OPENSIMPLEX_CONSTEXPR14 constexpr
+#else
+    #define OPENSIMPLEX_CONSTEXPR14 inline
+#endif
+
+/*
+ * Enables an instruction set for a single function so that SIMD kernels can
+ * be compiled without raising the baseline architecture of the whole
+ * translation unit. MSVC allows intrinsics anywhere, so it needs nothing.
+ */
+#if OPENSIMPLEX_IS_X86 && (defined(__GNUC__) || defined(__clang__))
+    #define OPENSIMPLEX_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define OPENSIMPLEX_TARGET(isa)
+#endif
+
+/*
+ * Whether the batch kernels can all be compiled into one binary and picked
+ * at runtime from the features of the CPU it runs on (see Dispatch.h).
+ * Otherwise the kernel is fixed by the instruction sets the compiler targets.
+ */
+#if OPENSIMPLEX_IS_X86 && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+    #define OPENSIMPLEX_HAS_DISPATCH 1
+#else
+    #define OPENSIMPLEX_HAS_DISPATCH 0
+#endif
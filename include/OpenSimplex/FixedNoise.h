@@ -0,0 +1,285 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+#include "Context.h"
+#include "Lattice.h"
+#include "VertexTables.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * OpenSimplex noise in fixed point, for simulations that must produce the
+ * same values on every machine. Coordinates and results are 16.16 fixed
+ * point: one is 65536, and results lie within [-65536, 65536]. Inputs are
+ * therefore limited to the +-32768 lattice units an int32_t holds in this
+ * format, so scale or wrap coordinates to stay inside it. Nothing in
+ * between is floating point, so the results are the same whatever the
+ * compiler, its optimizations or the CPU. They follow noise2 and noise3 to
+ * within about 1e-4 on average and 1e-3 at most, but are not identical to
+ * them.
+ *
+ * Inside a super-cell the lattice math is 14-bit fixed point in 32-bit
+ * integers, and only placing the point on the lattice and accumulating the
+ * contributions need 32x32 -> 64-bit multiplies, so the code maps onto
+ * 32-bit SIMD lanes. 3D selects its vertices through VertexTables without
+ * branching on the region.
+ */
+class FixedNoise
+{
+public:
+    static const int fractionBits = 16;
+    static const int32_t one = 1 << fractionBits;
+
+    inline static int32_t noise2(OPENSIMPLEX_GPU_CONSTANT const Context& context, int32_t x, int32_t y);
+    inline static int32_t noise3(OPENSIMPLEX_GPU_CONSTANT const Context& context, int32_t x, int32_t y, int32_t z);
+
+    template <typename Lattice> inline static int32_t noise2(const Lattice& lattice, int32_t x, int32_t y);
+    template <typename Lattice> inline static int32_t noise3(const Lattice& lattice, int32_t x, int32_t y, int32_t z);
+
+private:
+    static const int localBits = 14;
+    static const int32_t localOne = 1 << localBits;
+
+    inline static int64_t floorShift(int64_t x, int bits);
+    inline static int32_t square(int32_t x);
+    inline static int32_t squish(int32_t x, int32_t squishConstant);
+    inline static int32_t result(int64_t value, int32_t normConstant);
+
+    template <typename Lattice> inline static int64_t contribution2(const Lattice& lattice, int32_t xsv, int32_t ysv, int32_t dx, int32_t dy);
+    template <typename Lattice> inline static int64_t contribution3(const Lattice& lattice, int32_t xsb, int32_t ysb, int32_t zsb,
+                                                                    int32_t dx0, int32_t dy0, int32_t dz0,
+                                                                    OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex);
+};
+
+int32_t FixedNoise::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int32_t x, int32_t y)
+{
+    return noise2(ContextLattice(ctx), x, y);
+}
+
+int32_t FixedNoise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int32_t x, int32_t y, int32_t z)
+{
+    return noise3(ContextLattice(ctx), x, y, z);
+}
+
+/*
+ * 2D OpenSimplex (Simplectic) Noise in fixed point, with vertex gradients
+ * from lattice.
+ */
+template <typename Lattice>
+int32_t FixedNoise::noise2(const Lattice& lattice, int32_t x, int32_t y)
+{
+    const int64_t stretchConstant = -907633386; /* (1 / sqrt(2 + 1) - 1) / 2, 0.32 fixed point */
+    const int32_t squishConstant = 23988; /* (sqrt(2 + 1) - 1) / 2, 16.16 fixed point */
+    const int32_t normConstant = 47;
+
+    /* Place input coordinates onto grid, and floor to get the rhombus super-cell origin. */
+    int64_t stretchOffset = floorShift(x * stretchConstant + y * stretchConstant, 32);
+    int64_t xs = x + stretchOffset;
+    int64_t ys = y + stretchOffset;
+    int32_t xsb = (int32_t) floorShift(xs, fractionBits);
+    int32_t ysb = (int32_t) floorShift(ys, fractionBits);
+
+    /* Grid coordinates relative to the rhombus origin, and the positions relative to it they unskew to. */
+    int32_t xins = (int32_t) (xs - (int64_t) xsb * one) >> (fractionBits - localBits);
+    int32_t yins = (int32_t) (ys - (int64_t) ysb * one) >> (fractionBits - localBits);
+    int32_t inSum = xins + yins;
+    int32_t dx0 = xins + squish(inSum, squishConstant);
+    int32_t dy0 = yins + squish(inSum, squishConstant);
+
+    int32_t squish1 = squish(localOne, squishConstant);
+    int32_t squish2 = squish(2 * localOne, squishConstant);
+
+    /* Contributions (1,0) and (0,1) */
+    int64_t value = contribution2(lattice, xsb + 1, ysb + 0, dx0 - localOne - squish1, dy0 - squish1);
+    value += contribution2(lattice, xsb + 0, ysb + 1, dx0 - squish1, dy0 - localOne - squish1);
+
+    int32_t xsv_ext, ysv_ext, dx_ext, dy_ext;
+    if (inSum <= localOne) { /* We're inside the triangle (2-Simplex) at (0,0) */
+        int32_t zins = localOne - inSum;
+        if (zins > xins || zins > yins) { /* (0,0) is one of the closest two triangular vertices */
+            if (xins > yins) {
+                xsv_ext = xsb + 1;
+                ysv_ext = ysb - 1;
+                dx_ext = dx0 - localOne;
+                dy_ext = dy0 + localOne;
+            } else {
+                xsv_ext = xsb - 1;
+                ysv_ext = ysb + 1;
+                dx_ext = dx0 + localOne;
+                dy_ext = dy0 - localOne;
+            }
+        } else { /* (1,0) and (0,1) are the closest two vertices. */
+            xsv_ext = xsb + 1;
+            ysv_ext = ysb + 1;
+            dx_ext = dx0 - localOne - squish2;
+            dy_ext = dy0 - localOne - squish2;
+        }
+    } else { /* We're inside the triangle (2-Simplex) at (1,1) */
+        int32_t zins = 2 * localOne - inSum;
+        if (zins < xins || zins < yins) { /* (0,0) is one of the closest two triangular vertices */
+            if (xins > yins) {
+                xsv_ext = xsb + 2;
+                ysv_ext = ysb + 0;
+                dx_ext = dx0 - 2 * localOne - squish2;
+                dy_ext = dy0 - squish2;
+            } else {
+                xsv_ext = xsb + 0;
+                ysv_ext = ysb + 2;
+                dx_ext = dx0 - squish2;
+                dy_ext = dy0 - 2 * localOne - squish2;
+            }
+        } else { /* (1,0) and (0,1) are the closest two vertices. */
+            xsv_ext = xsb;
+            ysv_ext = ysb;
+            dx_ext = dx0;
+            dy_ext = dy0;
+        }
+        xsb += 1;
+        ysb += 1;
+        dx0 = dx0 - localOne - squish2;
+        dy0 = dy0 - localOne - squish2;
+    }
+
+    /* Contribution (0,0) or (1,1), and the extra vertex */
+    value += contribution2(lattice, xsb, ysb, dx0, dy0);
+    value += contribution2(lattice, xsv_ext, ysv_ext, dx_ext, dy_ext);
+
+    return result(value, normConstant);
+}
+
+/*
+ * 3D OpenSimplex (Simplectic) Noise in fixed point, with vertex gradients
+ * from lattice. The vertices come from VertexTables as in
+ * Noise::noise3Table.
+ */
+template <typename Lattice>
+int32_t FixedNoise::noise3(const Lattice& lattice, int32_t x, int32_t y, int32_t z)
+{
+    const int64_t stretchConstant = -715827883; /* (1 / sqrt(3 + 1) - 1) / 3, 0.32 fixed point */
+    const int32_t squishConstant = 21845; /* (sqrt(3 + 1) - 1) / 3, 16.16 fixed point */
+    const int32_t normConstant = 103;
+
+    /* Place input coordinates on simplectic honeycomb, and floor to get the rhombohedron super-cell origin. */
+    int64_t stretchOffset = floorShift(x * stretchConstant + y * stretchConstant + z * stretchConstant, 32);
+    int64_t xs = x + stretchOffset;
+    int64_t ys = y + stretchOffset;
+    int64_t zs = z + stretchOffset;
+    int32_t xsb = (int32_t) floorShift(xs, fractionBits);
+    int32_t ysb = (int32_t) floorShift(ys, fractionBits);
+    int32_t zsb = (int32_t) floorShift(zs, fractionBits);
+
+    /* Honeycomb coordinates relative to the rhombohedral origin, and the positions relative to it they unskew to. */
+    int32_t xins = (int32_t) (xs - (int64_t) xsb * one) >> (fractionBits - localBits);
+    int32_t yins = (int32_t) (ys - (int64_t) ysb * one) >> (fractionBits - localBits);
+    int32_t zins = (int32_t) (zs - (int64_t) zsb * one) >> (fractionBits - localBits);
+    int32_t inSum = xins + yins + zins;
+    int32_t dx0 = xins + squish(inSum, squishConstant);
+    int32_t dy0 = yins + squish(inSum, squishConstant);
+    int32_t dz0 = zins + squish(inSum, squishConstant);
+
+    int key = RegionClassifier::classify3(xins, yins, zins, inSum, localOne);
+    int region = key >> 6;
+
+    int64_t value = 0;
+    for (int k = 0; k < regionVertexCount3D[region]; k++)
+        value += contribution3(lattice, xsb, ysb, zsb, dx0, dy0, dz0, regionVertices3D[region][k]);
+
+    int extra = extraVertexIndex3D[key];
+    for (int k = 0; k < 2; k++)
+        value += contribution3(lattice, xsb, ysb, zsb, dx0, dy0, dz0, extraVertices3D[extra][k]);
+
+    return result(value, normConstant);
+}
+
+/* Shifts x right by bits, rounding towards negative infinity. */
+int64_t FixedNoise::floorShift(int64_t x, int bits)
+{
+    return x >= 0 ? x >> bits : ~(~x >> bits);
+}
+
+/* The square of a local fixed point value under 4 in magnitude. */
+int32_t FixedNoise::square(int32_t x)
+{
+    return (int32_t) (((uint32_t) x * (uint32_t) x) >> localBits);
+}
+
+/* x times a 16.16 squish constant, rounded to the nearest local unit. */
+int32_t FixedNoise::squish(int32_t x, int32_t squishConstant)
+{
+    return (int32_t) floorShift(x * squishConstant + (1 << 15), 16);
+}
+
+/* Turns the sum of the contributions into a 16.16 result. */
+int32_t FixedNoise::result(int64_t value, int32_t normConstant)
+{
+    return (int32_t) floorShift(value / normConstant, 2 * localBits - fractionBits);
+}
+
+/*
+ * attn^4 * extrapolate for one vertex, displaced by (dx, dy) from the
+ * point, with attn = 2 - dx^2 - dy^2 when that is positive. The result has
+ * 28 fractional bits.
+ */
+template <typename Lattice>
+int64_t FixedNoise::contribution2(const Lattice& lattice, int32_t xsv, int32_t ysv, int32_t dx, int32_t dy)
+{
+    int32_t attn = 2 * localOne - square(dx) - square(dy);
+    if (attn <= 0)
+        return 0;
+    attn = square(attn < 2 * localOne ? attn : 2 * localOne - 1); /* Keeps attn^2 under 4 at the vertex itself. */
+    return (int64_t) square(attn) * lattice.extrapolate2(xsv, ysv, dx, dy);
+}
+
+/* As contribution2, for a vertex of VertexTables relative to the super-cell origin. */
+template <typename Lattice>
+int64_t FixedNoise::contribution3(const Lattice& lattice, int32_t xsb, int32_t ysb, int32_t zsb,
+                                  int32_t dx0, int32_t dy0, int32_t dz0,
+                                  OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex)
+{
+    const int32_t squishConstant = 21845;
+
+    int32_t squishOffset = squish((vertex.x + vertex.y + vertex.z) * localOne, squishConstant);
+    int32_t dx = dx0 - vertex.x * localOne - squishOffset;
+    int32_t dy = dy0 - vertex.y * localOne - squishOffset;
+    int32_t dz = dz0 - vertex.z * localOne - squishOffset;
+
+    int32_t attn = 2 * localOne - square(dx) - square(dy) - square(dz);
+    if (attn <= 0)
+        return 0;
+    attn = square(attn < 2 * localOne ? attn : 2 * localOne - 1);
+    return (int64_t) square(attn) * lattice.extrapolate3(xsb + vertex.x, ysb + vertex.y, zsb + vertex.z, dx, dy, dz);
+}
+
+}
@@ -0,0 +1,267 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+#include "Context.h"
+#include "Noise.h"
+
+#if !OPENSIMPLEX_IS_GPU
+    #include <cstddef>
+
+    #include "NoiseBatch.h"
+#endif
+
+namespace OpenSimplex
+{
+
+/*
+ * Fractal Brownian motion: the sum of Octaves layers of noise, each at
+ * lacunarity times the frequency of the one before and gain times its
+ * amplitude. The sum is normalized by the total amplitude so it keeps the
+ * range of a single octave. The octave loop is unrolled at compile time.
+ *
+ * The array forms evaluate each octave over a block of points with
+ * NoiseBatch, so the octaves are vectorized across points. They return the
+ * same values as the single point forms.
+ *
+ * Every octave is Noise at the point times its frequency, so the point times
+ * the highest frequency, frequency * lacunarity^(Octaves - 1), must stay in
+ * the range Noise takes. Its lattice coordinates are int32_t, which limits
+ * coordinates to about 1e9 in magnitude.
+ */
+template <int Octaves, int Dim>
+class Fractal
+{
+public:
+    static_assert(Octaves >= 1, "A fractal needs at least one octave.");
+    static_assert(Dim >= 2 && Dim <= 4, "Noise is only available in 2, 3 and 4 dimensions.");
+
+    inline explicit Fractal(float frequency = 1.0f, float lacunarity = 2.0f, float gain = 0.5f);
+
+    inline float noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y) const;
+    inline float noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z) const;
+    inline float noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z, float w) const;
+
+#if !OPENSIMPLEX_IS_GPU
+    inline void noiseBatch(const Context& context, const float* xs, const float* ys, float* out, size_t count) const;
+    inline void noiseBatch(const Context& context, const float* xs, const float* ys, const float* zs, float* out, size_t count) const;
+    inline void noiseBatch(const Context& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count) const;
+#endif
+
+private:
+    template <int Octave, int Count> friend struct FractalOctave;
+
+    float frequencies[Octaves];
+    float weights[Octaves];
+};
+
+/*
+ * Adds octaves Octave to Count - 1 of a Fractal onto value, in order. Each
+ * octave is a separate instantiation, which unrolls the octave loop.
+ */
+template <int Octave, int Count>
+struct FractalOctave
+{
+    template <typename F>
+    inline static float sum2(const F& fractal, OPENSIMPLEX_GPU_CONSTANT const Context& context, float value, float x, float y)
+    {
+        float frequency = fractal.frequencies[Octave];
+        value += fractal.weights[Octave] * Noise::noise2(context, x * frequency, y * frequency);
+        return FractalOctave<Octave + 1, Count>::sum2(fractal, context, value, x, y);
+    }
+
+    template <typename F>
+    inline static float sum3(const F& fractal, OPENSIMPLEX_GPU_CONSTANT const Context& context, float value, float x, float y, float z)
+    {
+        float frequency = fractal.frequencies[Octave];
+        value += fractal.weights[Octave] * Noise::noise3(context, x * frequency, y * frequency, z * frequency);
+        return FractalOctave<Octave + 1, Count>::sum3(fractal, context, value, x, y, z);
+    }
+
+    template <typename F>
+    inline static float sum4(const F& fractal, OPENSIMPLEX_GPU_CONSTANT const Context& context, float value, float x, float y, float z, float w)
+    {
+        float frequency = fractal.frequencies[Octave];
+        value += fractal.weights[Octave] * Noise::noise4(context, x * frequency, y * frequency, z * frequency, w * frequency);
+        return FractalOctave<Octave + 1, Count>::sum4(fractal, context, value, x, y, z, w);
+    }
+};
+
+template <int Count>
+struct FractalOctave<Count, Count>
+{
+    template <typename F>
+    inline static float sum2(const F&, OPENSIMPLEX_GPU_CONSTANT const Context&, float value, float, float)
+    {
+        return value;
+    }
+
+    template <typename F>
+    inline static float sum3(const F&, OPENSIMPLEX_GPU_CONSTANT const Context&, float value, float, float, float)
+    {
+        return value;
+    }
+
+    template <typename F>
+    inline static float sum4(const F&, OPENSIMPLEX_GPU_CONSTANT const Context&, float value, float, float, float, float)
+    {
+        return value;
+    }
+};
+
+template <int Octaves, int Dim>
+Fractal<Octaves, Dim>::Fractal(float frequency, float lacunarity, float gain)
+{
+    float amplitude = 1.0f;
+    float totalAmplitude = 0.0f;
+    for (int octave = 0; octave < Octaves; octave++) {
+        frequencies[octave] = frequency;
+        weights[octave] = amplitude;
+        totalAmplitude += amplitude;
+        frequency *= lacunarity;
+        amplitude *= gain;
+    }
+
+    for (int octave = 0; octave < Octaves; octave++)
+        weights[octave] /= totalAmplitude;
+}
+
+template <int Octaves, int Dim>
+float Fractal<Octaves, Dim>::noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y) const
+{
+    static_assert(Dim == 2, "This fractal isn't 2D.");
+    float value = weights[0] * Noise::noise2(context, x * frequencies[0], y * frequencies[0]);
+    return FractalOctave<1, Octaves>::sum2(*this, context, value, x, y);
+}
+
+template <int Octaves, int Dim>
+float Fractal<Octaves, Dim>::noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z) const
+{
+    static_assert(Dim == 3, "This fractal isn't 3D.");
+    float value = weights[0] * Noise::noise3(context, x * frequencies[0], y * frequencies[0], z * frequencies[0]);
+    return FractalOctave<1, Octaves>::sum3(*this, context, value, x, y, z);
+}
+
+template <int Octaves, int Dim>
+float Fractal<Octaves, Dim>::noise(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z, float w) const
+{
+    static_assert(Dim == 4, "This fractal isn't 4D.");
+    float value = weights[0] * Noise::noise4(context, x * frequencies[0], y * frequencies[0], z * frequencies[0], w * frequencies[0]);
+    return FractalOctave<1, Octaves>::sum4(*this, context, value, x, y, z, w);
+}
+
+#if !OPENSIMPLEX_IS_GPU
+
+/*
+ * The array forms work through the points in blocks, scaling each block to
+ * an octave's frequency and evaluating it with NoiseBatch before moving on
+ * to the next octave. A block is summed on the stack and written to out
+ * once all of its inputs have been read, so out may be one of the input
+ * arrays, but must not overlap them in any other way. The points must stay
+ * in range at the highest octave, as for the single point forms.
+ */
+template <int Octaves, int Dim>
+void Fractal<Octaves, Dim>::noiseBatch(const Context& context, const float* xs, const float* ys, float* out, size_t count) const
+{
+    static_assert(Dim == 2, "This fractal isn't 2D.");
+    const size_t blockSize = 1024;
+    float scaledX[blockSize], scaledY[blockSize], octave[blockSize], sum[blockSize];
+
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        for (int o = 0; o < Octaves; o++) {
+            for (size_t i = 0; i < n; i++) {
+                scaledX[i] = xs[begin + i] * frequencies[o];
+                scaledY[i] = ys[begin + i] * frequencies[o];
+            }
+            NoiseBatch::noise2Batch(context, scaledX, scaledY, octave, n);
+            for (size_t i = 0; i < n; i++)
+                sum[i] = o == 0 ? weights[o] * octave[i] : sum[i] + weights[o] * octave[i];
+        }
+        for (size_t i = 0; i < n; i++)
+            out[begin + i] = sum[i];
+    }
+}
+
+template <int Octaves, int Dim>
+void Fractal<Octaves, Dim>::noiseBatch(const Context& context, const float* xs, const float* ys, const float* zs, float* out, size_t count) const
+{
+    static_assert(Dim == 3, "This fractal isn't 3D.");
+    const size_t blockSize = 1024;
+    float scaledX[blockSize], scaledY[blockSize], scaledZ[blockSize], octave[blockSize], sum[blockSize];
+
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        for (int o = 0; o < Octaves; o++) {
+            for (size_t i = 0; i < n; i++) {
+                scaledX[i] = xs[begin + i] * frequencies[o];
+                scaledY[i] = ys[begin + i] * frequencies[o];
+                scaledZ[i] = zs[begin + i] * frequencies[o];
+            }
+            NoiseBatch::noise3Batch(context, scaledX, scaledY, scaledZ, octave, n);
+            for (size_t i = 0; i < n; i++)
+                sum[i] = o == 0 ? weights[o] * octave[i] : sum[i] + weights[o] * octave[i];
+        }
+        for (size_t i = 0; i < n; i++)
+            out[begin + i] = sum[i];
+    }
+}
+
+template <int Octaves, int Dim>
+void Fractal<Octaves, Dim>::noiseBatch(const Context& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count) const
+{
+    static_assert(Dim == 4, "This fractal isn't 4D.");
+    const size_t blockSize = 1024;
+    float scaledX[blockSize], scaledY[blockSize], scaledZ[blockSize], scaledW[blockSize], octave[blockSize], sum[blockSize];
+
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        for (int o = 0; o < Octaves; o++) {
+            for (size_t i = 0; i < n; i++) {
+                scaledX[i] = xs[begin + i] * frequencies[o];
+                scaledY[i] = ys[begin + i] * frequencies[o];
+                scaledZ[i] = zs[begin + i] * frequencies[o];
+                scaledW[i] = ws[begin + i] * frequencies[o];
+            }
+            NoiseBatch::noise4Batch(context, scaledX, scaledY, scaledZ, scaledW, octave, n);
+            for (size_t i = 0; i < n; i++)
+                sum[i] = o == 0 ? weights[o] * octave[i] : sum[i] + weights[o] * octave[i];
+        }
+        for (size_t i = 0; i < n; i++)
+            out[begin + i] = sum[i];
+    }
+}
+
+#endif
+
+}
@@ -0,0 +1,565 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+#include "Context.h"
+#include "Gradients.h"
+
+#if !OPENSIMPLEX_IS_GPU
+    #include <cstddef>
+#endif
+
+namespace OpenSimplex
+{
+
+/*
+ * A lattice is where Noise gets the gradient of each lattice vertex from.
+ * It provides extrapolate2/3/4, which return the dot product of the vertex
+ * gradient with the displacement (dx, dy, ...) of the point from the vertex.
+ *
+ * ContextLattice hashes the vertex coordinates through a Context, which is
+ * what the Noise functions taking a Context use. It is BasicContextLattice
+ * over Context; CompactContextLattice hashes through a CompactContext in
+ * the same way.
+ */
+template <typename ContextType>
+class BasicContextLattice
+{
+public:
+    inline explicit BasicContextLattice(OPENSIMPLEX_GPU_CONSTANT const ContextType& context);
+
+    template <typename Index, typename T> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index, typename T> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+    template <typename Index, typename T> inline T extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const;
+
+private:
+    OPENSIMPLEX_GPU_CONSTANT const ContextType& ctx;
+};
+
+typedef BasicContextLattice<Context> ContextLattice;
+typedef BasicContextLattice<CompactContext> CompactContextLattice;
+
+template <typename ContextType>
+BasicContextLattice<ContextType>::BasicContextLattice(OPENSIMPLEX_GPU_CONSTANT const ContextType& context)
+    : ctx(context)
+{
+}
+
+template <typename ContextType>
+template <typename Index, typename T>
+T BasicContextLattice<ContextType>::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    int index = ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] & 0x0E;
+    return gradients2D[index] * dx
+    + gradients2D[index + 1] * dy;
+}
+
+template <typename ContextType>
+template <typename Index, typename T>
+T BasicContextLattice<ContextType>::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    int index = ctx.permGradIndex3D[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF];
+    return gradients3D[index] * dx
+    + gradients3D[index + 1] * dy
+    + gradients3D[index + 2] * dz;
+}
+
+template <typename ContextType>
+template <typename Index, typename T>
+T BasicContextLattice<ContextType>::extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const
+{
+    int index = ctx.perm[(ctx.perm[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF] + wsb) & 0xFF] & 0xFC;
+    return gradients4D[index] * dx
+    + gradients4D[index + 1] * dy
+    + gradients4D[index + 2] * dz
+    + gradients4D[index + 3] * dw;
+}
+
+/*
+ * Hashes through a HashContext. The vertex coordinates are each multiplied
+ * by a large odd constant and summed with the seed, the sum is mixed as in
+ * the MurmurHash3 finalizer, and the top bits of the result select the
+ * gradient. hash is public so that SIMD code can select the same gradients.
+ */
+class HashLattice
+{
+public:
+    inline explicit HashLattice(OPENSIMPLEX_GPU_CONSTANT const HashContext& context);
+
+    template <typename Index, typename T> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index, typename T> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+    template <typename Index, typename T> inline T extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const;
+
+    inline static uint32_t hash(uint32_t seed, uint32_t x, uint32_t y, uint32_t z, uint32_t w);
+
+private:
+    uint32_t seed;
+};
+
+HashLattice::HashLattice(OPENSIMPLEX_GPU_CONSTANT const HashContext& context)
+    : seed(context.seed)
+{
+}
+
+uint32_t HashLattice::hash(uint32_t seed, uint32_t x, uint32_t y, uint32_t z, uint32_t w)
+{
+    uint32_t h = seed + x * 0x8DA6B343u + y * 0xD8163841u + z * 0xCB1AB31Fu + w * 0x165667B1u;
+    h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+    return (h ^ (h >> 13)) * 0xC2B2AE35u;
+}
+
+template <typename Index, typename T>
+T HashLattice::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    /* The top three bits pick one of the eight gradients. */
+    int index = (int) (hash(seed, (uint32_t) xsb, (uint32_t) ysb, 0, 0) >> 29) << 1;
+    return gradients2D[index] * dx
+    + gradients2D[index + 1] * dy;
+}
+
+template <typename Index, typename T>
+T HashLattice::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    /* Scales the top 16 bits down to one of the 24 gradients. */
+    int index = (int) (((hash(seed, (uint32_t) xsb, (uint32_t) ysb, (uint32_t) zsb, 0) >> 16) * 24) >> 16) * 3;
+    return gradients3D[index] * dx
+    + gradients3D[index + 1] * dy
+    + gradients3D[index + 2] * dz;
+}
+
+template <typename Index, typename T>
+T HashLattice::extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const
+{
+    /* The top six bits pick one of the 64 gradients. */
+    int index = (int) (hash(seed, (uint32_t) xsb, (uint32_t) ysb, (uint32_t) zsb, (uint32_t) wsb) >> 26) << 2;
+    return gradients4D[index] * dx
+    + gradients4D[index + 1] * dy
+    + gradients4D[index + 2] * dz
+    + gradients4D[index + 3] * dw;
+}
+
+/*
+ * Hashes like ContextLattice, and also sums the derivatives of the
+ * contributions Noise makes with respect to the sample position. Noise adds
+ * attn^4 * extrapolate for each vertex where attn = 2 - |d|^2 is positive, d
+ * being the displacement of the point from the vertex, so the derivative of
+ * a contribution along x is attn^4 * gx - 8 * attn^3 * dx * extrapolate.
+ * The sums start at zero and are read out once noise has been evaluated.
+ */
+template <typename T>
+class DerivativeLattice
+{
+public:
+    inline explicit DerivativeLattice(OPENSIMPLEX_GPU_CONSTANT const Context& context);
+
+    template <typename Index> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+    template <typename Index> inline T extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const;
+
+    mutable T derivX, derivY, derivZ, derivW;
+
+private:
+    OPENSIMPLEX_GPU_CONSTANT const Context& ctx;
+};
+
+template <typename T>
+DerivativeLattice<T>::DerivativeLattice(OPENSIMPLEX_GPU_CONSTANT const Context& context)
+    : derivX(0), derivY(0), derivZ(0), derivW(0), ctx(context)
+{
+}
+
+template <typename T>
+template <typename Index>
+T DerivativeLattice<T>::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    int index = ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] & 0x0E;
+    T gx = gradients2D[index];
+    T gy = gradients2D[index + 1];
+    T extrapolation = gx * dx + gy * dy;
+
+    T attn = 2 - dx * dx - dy * dy;
+    T attn2 = attn * attn;
+    T attn4 = attn2 * attn2;
+    T falloff = 8 * attn2 * attn * extrapolation;
+    derivX += attn4 * gx - falloff * dx;
+    derivY += attn4 * gy - falloff * dy;
+    return extrapolation;
+}
+
+template <typename T>
+template <typename Index>
+T DerivativeLattice<T>::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    int index = ctx.permGradIndex3D[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF];
+    T gx = gradients3D[index];
+    T gy = gradients3D[index + 1];
+    T gz = gradients3D[index + 2];
+    T extrapolation = gx * dx + gy * dy + gz * dz;
+
+    T attn = 2 - dx * dx - dy * dy - dz * dz;
+    T attn2 = attn * attn;
+    T attn4 = attn2 * attn2;
+    T falloff = 8 * attn2 * attn * extrapolation;
+    derivX += attn4 * gx - falloff * dx;
+    derivY += attn4 * gy - falloff * dy;
+    derivZ += attn4 * gz - falloff * dz;
+    return extrapolation;
+}
+
+template <typename T>
+template <typename Index>
+T DerivativeLattice<T>::extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const
+{
+    int index = ctx.perm[(ctx.perm[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF] + wsb) & 0xFF] & 0xFC;
+    T gx = gradients4D[index];
+    T gy = gradients4D[index + 1];
+    T gz = gradients4D[index + 2];
+    T gw = gradients4D[index + 3];
+    T extrapolation = gx * dx + gy * dy + gz * dz + gw * dw;
+
+    T attn = 2 - dx * dx - dy * dy - dz * dz - dw * dw;
+    T attn2 = attn * attn;
+    T attn4 = attn2 * attn2;
+    T falloff = 8 * attn2 * attn * extrapolation;
+    derivX += attn4 * gx - falloff * dx;
+    derivY += attn4 * gy - falloff * dy;
+    derivZ += attn4 * gz - falloff * dz;
+    derivW += attn4 * gw - falloff * dw;
+    return extrapolation;
+}
+
+/*
+ * Hashes the same vertex through several Contexts at once, so that one
+ * traversal of the lattice evaluates noise for every seed. For each vertex
+ * Noise offers, it adds attn^4 * extrapolate for every Context to the
+ * matching entry of values, recomputing attn exactly as Noise does. The
+ * values must start at zero, and the value Noise itself returns is zero.
+ */
+template <typename T>
+class MultiSeedLattice
+{
+public:
+    inline MultiSeedLattice(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T* values);
+
+    template <typename Index> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+    template <typename Index> inline T extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const;
+
+private:
+    OPENSIMPLEX_GPU_CONSTANT const Context* contexts;
+    int count;
+    T* values;
+};
+
+template <typename T>
+MultiSeedLattice<T>::MultiSeedLattice(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T* values)
+    : contexts(contexts), count(count), values(values)
+{
+}
+
+template <typename T>
+template <typename Index>
+T MultiSeedLattice<T>::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    T attn = 2 - dx * dx - dy * dy;
+    attn *= attn;
+    T attn4 = attn * attn;
+    for (int i = 0; i < count; i++)
+        values[i] += attn4 * ContextLattice(contexts[i]).extrapolate2(xsb, ysb, dx, dy);
+    return 0;
+}
+
+template <typename T>
+template <typename Index>
+T MultiSeedLattice<T>::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    T attn = 2 - dx * dx - dy * dy - dz * dz;
+    attn *= attn;
+    T attn4 = attn * attn;
+    for (int i = 0; i < count; i++)
+        values[i] += attn4 * ContextLattice(contexts[i]).extrapolate3(xsb, ysb, zsb, dx, dy, dz);
+    return 0;
+}
+
+template <typename T>
+template <typename Index>
+T MultiSeedLattice<T>::extrapolate4(Index xsb, Index ysb, Index zsb, Index wsb, T dx, T dy, T dz, T dw) const
+{
+    T attn = 2 - dx * dx - dy * dy - dz * dz - dw * dw;
+    attn *= attn;
+    T attn4 = attn * attn;
+    for (int i = 0; i < count; i++)
+        values[i] += attn4 * ContextLattice(contexts[i]).extrapolate4(xsb, ysb, zsb, wsb, dx, dy, dz, dw);
+    return 0;
+}
+
+/*
+ * Hashes through a Context like ContextLattice, after wrapping each lattice
+ * coordinate into [0, period) for its axis. Noise over it repeats every
+ * period steps along each lattice axis. Periods may be any positive
+ * integers; a period that is a multiple of 256 gives the same gradients as
+ * ContextLattice. Periods below 1 are taken as 1, since wrapping into an
+ * empty range has no meaning.
+ */
+class PeriodicLattice
+{
+public:
+    inline PeriodicLattice(OPENSIMPLEX_GPU_CONSTANT const Context& context, int periodX, int periodY, int periodZ = 1);
+
+    template <typename Index, typename T> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index, typename T> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+
+private:
+    template <typename Index> inline static Index wrap(Index x, int period);
+
+    ContextLattice lattice;
+    int periodX, periodY, periodZ;
+};
+
+PeriodicLattice::PeriodicLattice(OPENSIMPLEX_GPU_CONSTANT const Context& context, int periodX, int periodY, int periodZ)
+    : lattice(context), periodX(periodX > 1 ? periodX : 1), periodY(periodY > 1 ? periodY : 1), periodZ(periodZ > 1 ? periodZ : 1)
+{
+}
+
+template <typename Index, typename T>
+T PeriodicLattice::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    return lattice.extrapolate2(wrap(xsb, periodX), wrap(ysb, periodY), dx, dy);
+}
+
+template <typename Index, typename T>
+T PeriodicLattice::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    return lattice.extrapolate3(wrap(xsb, periodX), wrap(ysb, periodY), wrap(zsb, periodZ), dx, dy, dz);
+}
+
+template <typename Index>
+Index PeriodicLattice::wrap(Index x, int period)
+{
+    Index r = x % period;
+    return r < 0 ? r + period : r;
+}
+
+#if !OPENSIMPLEX_IS_GPU
+
+/*
+ * The vertices of a box of the lattice, numbered x fastest, then y, then z.
+ * GridLattice and VolumeLattice lay their gradients out by it.
+ */
+class LatticeBox
+{
+public:
+    inline LatticeBox();
+
+    inline static size_t vertexCount(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax);
+
+    inline void cover3(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax);
+    inline void resolve3(const Context& context, float* x, float* y, float* z, int step) const;
+
+    template <typename Index> inline int64_t vertex(Index xsb, Index ysb, Index zsb) const;
+
+private:
+    int64_t xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax;
+    int64_t strideY, strideZ, bias;
+};
+
+LatticeBox::LatticeBox()
+    : xsbMin(0), ysbMin(0), zsbMin(0), xsbMax(-1), ysbMax(-1), zsbMax(-1), strideY(0), strideZ(0), bias(0)
+{
+}
+
+size_t LatticeBox::vertexCount(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax)
+{
+    return (size_t) (xsbMax - xsbMin + 1) * (size_t) (ysbMax - ysbMin + 1) * (size_t) (zsbMax - zsbMin + 1);
+}
+
+void LatticeBox::cover3(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax)
+{
+    this->xsbMin = xsbMin; this->ysbMin = ysbMin; this->zsbMin = zsbMin;
+    this->xsbMax = xsbMax; this->ysbMax = ysbMax; this->zsbMax = zsbMax;
+    strideY = xsbMax - xsbMin + 1;
+    strideZ = strideY * (ysbMax - ysbMin + 1);
+    bias = xsbMin + ysbMin * strideY + zsbMin * strideZ;
+}
+
+/*
+ * Writes the gradient of each vertex of the box, in order, to x, y and z,
+ * advancing each by step floats per vertex.
+ */
+void LatticeBox::resolve3(const Context& context, float* x, float* y, float* z, int step) const
+{
+    for (int64_t zsb = zsbMin; zsb <= zsbMax; zsb++) {
+        for (int64_t ysb = ysbMin; ysb <= ysbMax; ysb++) {
+            for (int64_t xsb = xsbMin; xsb <= xsbMax; xsb++) {
+                int index = context.permGradIndex3D[(context.perm[(context.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF];
+                *x = gradients3D[index]; x += step;
+                *y = gradients3D[index + 1]; y += step;
+                *z = gradients3D[index + 2]; z += step;
+            }
+        }
+    }
+}
+
+template <typename Index>
+int64_t LatticeBox::vertex(Index xsb, Index ysb, Index zsb) const
+{
+    return xsb + (int64_t) ysb * strideY + (int64_t) zsb * strideZ - bias;
+}
+
+/*
+ * Holds the gradients of every lattice vertex in a box, resolved once
+ * through a Context and stored as floats, so that samples inside the box
+ * need neither the permutation lookups nor the conversions from int8.
+ * A box may hold up to capacity vertices, and vertices outside the box most
+ * recently covered must not be asked for.
+ */
+class GridLattice
+{
+public:
+    static const int capacity = 1024;
+
+    inline explicit GridLattice(const Context& context);
+
+    inline void cover2(int64_t xsbMin, int64_t ysbMin, int64_t xsbMax, int64_t ysbMax);
+    inline void cover3(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax);
+
+    template <typename Index, typename T> inline T extrapolate2(Index xsb, Index ysb, T dx, T dy) const;
+    template <typename Index, typename T> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+
+private:
+    const Context& ctx;
+    float gradients[3 * capacity];
+    LatticeBox box;
+};
+
+GridLattice::GridLattice(const Context& context)
+    : ctx(context)
+{
+}
+
+/* A 2D box is a 3D box one vertex deep, at z = 0. */
+void GridLattice::cover2(int64_t xsbMin, int64_t ysbMin, int64_t xsbMax, int64_t ysbMax)
+{
+    box.cover3(xsbMin, ysbMin, 0, xsbMax, ysbMax, 0);
+
+    float* gradient = gradients;
+    for (int64_t ysb = ysbMin; ysb <= ysbMax; ysb++) {
+        for (int64_t xsb = xsbMin; xsb <= xsbMax; xsb++) {
+            int index = ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] & 0x0E;
+            *gradient++ = gradients2D[index];
+            *gradient++ = gradients2D[index + 1];
+        }
+    }
+}
+
+void GridLattice::cover3(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax)
+{
+    box.cover3(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+    box.resolve3(ctx, gradients, gradients + 1, gradients + 2, 3);
+}
+
+template <typename Index, typename T>
+T GridLattice::extrapolate2(Index xsb, Index ysb, T dx, T dy) const
+{
+    const float* gradient = &gradients[2 * box.vertex(xsb, ysb, (Index) 0)];
+    return gradient[0] * dx
+    + gradient[1] * dy;
+}
+
+template <typename Index, typename T>
+T GridLattice::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    const float* gradient = &gradients[3 * box.vertex(xsb, ysb, zsb)];
+    return gradient[0] * dx
+    + gradient[1] * dy
+    + gradient[2] * dz;
+}
+
+/*
+ * Holds the gradients of every lattice vertex in a 3D box like GridLattice,
+ * but in a buffer owned by the caller and sized to the box, laid out as
+ * structure of arrays: all x components, then all y, then all z. Boxes are
+ * therefore not limited in size, and the buffer can be recycled between
+ * boxes (see VolumeSampler). Vertices outside the box most recently covered
+ * must not be asked for.
+ */
+class VolumeLattice
+{
+public:
+    inline VolumeLattice();
+
+    inline static size_t vertexCount(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax);
+    inline void cover3(const Context& context, float* buffer, int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax);
+
+    template <typename Index, typename T> inline T extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const;
+
+private:
+    const float* gradientsX;
+    const float* gradientsY;
+    const float* gradientsZ;
+    LatticeBox box;
+};
+
+VolumeLattice::VolumeLattice()
+    : gradientsX(0), gradientsY(0), gradientsZ(0)
+{
+}
+
+/* The number of vertices in a box, whose gradients take three times as many floats. */
+size_t VolumeLattice::vertexCount(int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax)
+{
+    return LatticeBox::vertexCount(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+}
+
+void VolumeLattice::cover3(const Context& context, float* buffer, int64_t xsbMin, int64_t ysbMin, int64_t zsbMin, int64_t xsbMax, int64_t ysbMax, int64_t zsbMax)
+{
+    size_t count = vertexCount(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+    gradientsX = buffer;
+    gradientsY = buffer + count;
+    gradientsZ = buffer + 2 * count;
+    box.cover3(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+    box.resolve3(context, buffer, buffer + count, buffer + 2 * count, 1);
+}
+
+template <typename Index, typename T>
+T VolumeLattice::extrapolate3(Index xsb, Index ysb, Index zsb, T dx, T dy, T dz) const
+{
+    int64_t vertex = box.vertex(xsb, ysb, zsb);
+    return gradientsX[vertex] * dx
+    + gradientsY[vertex] * dy
+    + gradientsZ[vertex] * dz;
+}
+
+#endif
+
+}
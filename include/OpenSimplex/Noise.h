@@ -33,71 +33,570 @@
 
 #include "Environment.h"
 #include "Context.h"
+#include "Gradients.h"
+#include "Lattice.h"
+#include "VertexTables.h"
+
+#if !OPENSIMPLEX_IS_GPU
+    #include <cstddef>
+#endif
 
 namespace OpenSimplex
 {
 
-class Noise
+/* A noise value together with its partial derivatives along each axis. */
+template <typename T>
+struct BasicNoiseDeriv2
+{
+    T value;
+    T dx, dy;
+};
+
+typedef BasicNoiseDeriv2<float> NoiseDeriv2;
+
+template <typename T>
+struct BasicNoiseDeriv3
+{
+    T value;
+    T dx, dy, dz;
+};
+
+typedef BasicNoiseDeriv3<float> NoiseDeriv3;
+
+template <typename T>
+struct BasicNoiseDeriv4
+{
+    T value;
+    T dx, dy, dz, dw;
+};
+
+typedef BasicNoiseDeriv4<float> NoiseDeriv4;
+
+#if !OPENSIMPLEX_IS_GPU
+class Quantize;
+
+/* Writes raster samples unchanged, for fillGrid2 and fillGrid3. */
+template <typename T>
+struct RasterStore
+{
+    T* out;
+
+    inline explicit RasterStore(T* out) : out(out) {}
+    inline void operator()(size_t index, int i, int j, T value) const { out[index] = value; }
+};
+#endif
+
+/*
+ * OpenSimplex noise over the scalar type T (float or double), with lattice
+ * coordinates of type Index. Noise is the float version. Large worlds can
+ * query BasicNoise<double, int64_t> (DoubleNoise) in world coordinates
+ * directly, well beyond where float and 32-bit lattice coordinates break
+ * down.
+ */
+template <typename T, typename Index = int32_t>
+class BasicNoise
 {
 public:
-    inline static float noise2(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y);
-    inline static float noise3(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z);
-    inline static float noise4(OPENSIMPLEX_GPU_CONSTANT const Context& context, float x, float y, float z, float w);
+    inline static T noise2(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y);
+    inline static T noise3(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z);
+    inline static T noise4(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z, T w);
+
+    inline static T noise2(OPENSIMPLEX_GPU_CONSTANT const CompactContext& context, T x, T y);
+    inline static T noise3(OPENSIMPLEX_GPU_CONSTANT const CompactContext& context, T x, T y, T z);
+    inline static T noise4(OPENSIMPLEX_GPU_CONSTANT const CompactContext& context, T x, T y, T z, T w);
+
+    inline static T noise2(OPENSIMPLEX_GPU_CONSTANT const HashContext& context, T x, T y);
+    inline static T noise3(OPENSIMPLEX_GPU_CONSTANT const HashContext& context, T x, T y, T z);
+    inline static T noise4(OPENSIMPLEX_GPU_CONSTANT const HashContext& context, T x, T y, T z, T w);
+
+    inline static BasicNoiseDeriv2<T> noise2Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y);
+    inline static BasicNoiseDeriv3<T> noise3Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z);
+    inline static BasicNoiseDeriv4<T> noise4Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z, T w);
+
+    inline static void noise2Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T* out);
+    inline static void noise3Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T z, T* out);
+    inline static void noise4Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T z, T w, T* out);
+
+    inline static T noise2Periodic(OPENSIMPLEX_GPU_CONSTANT const Context& context, int periodX, int periodY, T x, T y);
+    inline static T noise3Periodic(OPENSIMPLEX_GPU_CONSTANT const Context& context, int periodX, int periodY, int periodZ, T x, T y, T z);
+
+    template <typename Lattice> inline static T noise2(const Lattice& lattice, T x, T y);
+    template <typename Lattice> inline static T noise3(const Lattice& lattice, T x, T y, T z);
+    template <typename Lattice> inline static T noise4(const Lattice& lattice, T x, T y, T z, T w);
+
+    inline static T noise3Table(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z);
+    template <typename Lattice> inline static T noise3Table(const Lattice& lattice, T x, T y, T z);
+    inline static T noise4Table(OPENSIMPLEX_GPU_CONSTANT const Context& context, T x, T y, T z, T w);
+    template <typename Lattice> inline static T noise4Table(const Lattice& lattice, T x, T y, T z, T w);
+
+#if !OPENSIMPLEX_IS_GPU
+    inline static void fillGrid2(const Context& context, T* out, T originX, T originY,
+                                 T stepX, T stepY, int width, int height);
+    inline static void fillGrid3(const Context& context, T* out, T originX, T originY, T originZ,
+                                 T stepX, T stepY, T stepZ, int width, int height, int depth);
+
+    inline static void fillGridRegion2(const Context& context, T* out, T originX, T originY,
+                                       T stepX, T stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd);
+    inline static void fillGridRegion3(const Context& context, T* out, T originX, T originY, T originZ,
+                                       T stepX, T stepY, T stepZ, int width, int height,
+                                       int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd);
+#endif
 
 private:
-    inline static float floor(float x);
-    inline static float extrapolate2(OPENSIMPLEX_GPU_CONSTANT const Context& context, int xsb, int ysb, float dx, float dy);
-    inline static float extrapolate3(OPENSIMPLEX_GPU_CONSTANT const Context& context, int xsb, int ysb, int zsb, float dx, float dy, float dz);
-    inline static float extrapolate4(OPENSIMPLEX_GPU_CONSTANT const Context& context, int xsb, int ysb, int zsb, int wsb, float dx, float dy, float dz, float dw);
+    inline static Index floor(T x);
+
+    inline static int classify4(T xins, T yins, T zins, T wins, T inSum);
+    template <typename Lattice> inline static T contribution3(const Lattice& lattice, T value, Index xsb, Index ysb, Index zsb,
+                                                              T dx0, T dy0, T dz0, OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex);
+    template <typename Lattice> inline static T contribution4(const Lattice& lattice, T value, Index xsb, Index ysb, Index zsb, Index wsb,
+                                                              T dx0, T dy0, T dz0, T dw0, OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex);
+
+#if !OPENSIMPLEX_IS_GPU
+    friend class Quantize;
+
+    template <typename Store> inline static void storeGridRegion2(const Context& context, const Store& store, T originX, T originY,
+                                                                  T stepX, T stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd);
+    template <typename Store> inline static void storeGridRegion3(const Context& context, const Store& store, T originX, T originY, T originZ,
+                                                                  T stepX, T stepY, T stepZ, int width, int height,
+                                                                  int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd);
+    template <typename Lattice, typename Store> inline static void fillTile2(const Lattice& lattice, const Store& store, T originX, T originY,
+                                                                             T stepX, T stepY, int width, int i0, int j0, int i1, int j1);
+    template <typename Lattice, typename Store> inline static void fillTile3(const Lattice& lattice, const Store& store, size_t offset, T originX, T originY, T z,
+                                                                             T stepX, T stepY, int width, int i0, int j0, int i1, int j1);
+#endif
 };
 
-/* 2D OpenSimplex (Simplectic) Noise. */
-float Noise::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float y)
+typedef BasicNoise<float> Noise;
+typedef BasicNoise<double, int64_t> DoubleNoise;
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y)
+{
+    return noise2(ContextLattice(ctx), x, y);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z)
 {
-    const float stretchConstant = -0.211324865405187f; /* (1 / sqrt(2 + 1) - 1 ) / 2; */
-    const float squishConstant = 0.366025403784439f; /* (sqrt(2 + 1) -1) / 2; */
-    const float normConstant = 47.0f;
+    return noise3(ContextLattice(ctx), x, y, z);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z, T w)
+{
+    return noise4(ContextLattice(ctx), x, y, z, w);
+}
+
+/*
+ * The same noise as through the Context the CompactContext was made from,
+ * with half the table footprint.
+ */
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise2(OPENSIMPLEX_GPU_CONSTANT const CompactContext& ctx, T x, T y)
+{
+    return noise2(CompactContextLattice(ctx), x, y);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise3(OPENSIMPLEX_GPU_CONSTANT const CompactContext& ctx, T x, T y, T z)
+{
+    return noise3(CompactContextLattice(ctx), x, y, z);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise4(OPENSIMPLEX_GPU_CONSTANT const CompactContext& ctx, T x, T y, T z, T w)
+{
+    return noise4(CompactContextLattice(ctx), x, y, z, w);
+}
+
+/*
+ * Noise with gradients selected by HashLattice rather than by permutation
+ * tables. It differs in value from the Context versions.
+ */
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise2(OPENSIMPLEX_GPU_CONSTANT const HashContext& ctx, T x, T y)
+{
+    return noise2(HashLattice(ctx), x, y);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise3(OPENSIMPLEX_GPU_CONSTANT const HashContext& ctx, T x, T y, T z)
+{
+    return noise3(HashLattice(ctx), x, y, z);
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise4(OPENSIMPLEX_GPU_CONSTANT const HashContext& ctx, T x, T y, T z, T w)
+{
+    return noise4(HashLattice(ctx), x, y, z, w);
+}
+
+/*
+ * 2D noise together with its analytic partial derivatives, which come from
+ * the same contributions as the value (see DerivativeLattice). The value is
+ * identical to noise2's.
+ */
+template <typename T, typename Index>
+BasicNoiseDeriv2<T> BasicNoise<T, Index>::noise2Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y)
+{
+    const T normConstant = 47;
+
+    DerivativeLattice<T> lattice(ctx);
+    BasicNoiseDeriv2<T> result;
+    result.value = noise2(lattice, x, y);
+    result.dx = lattice.derivX / normConstant;
+    result.dy = lattice.derivY / normConstant;
+    return result;
+}
+
+/* 3D noise together with its partial derivatives. See noise2Deriv. */
+template <typename T, typename Index>
+BasicNoiseDeriv3<T> BasicNoise<T, Index>::noise3Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z)
+{
+    const T normConstant = 103;
+
+    DerivativeLattice<T> lattice(ctx);
+    BasicNoiseDeriv3<T> result;
+    result.value = noise3(lattice, x, y, z);
+    result.dx = lattice.derivX / normConstant;
+    result.dy = lattice.derivY / normConstant;
+    result.dz = lattice.derivZ / normConstant;
+    return result;
+}
+
+/* 4D noise together with its partial derivatives. See noise2Deriv. */
+template <typename T, typename Index>
+BasicNoiseDeriv4<T> BasicNoise<T, Index>::noise4Deriv(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z, T w)
+{
+    const T normConstant = 30;
+
+    DerivativeLattice<T> lattice(ctx);
+    BasicNoiseDeriv4<T> result;
+    result.value = noise4(lattice, x, y, z, w);
+    result.dx = lattice.derivX / normConstant;
+    result.dy = lattice.derivY / normConstant;
+    result.dz = lattice.derivZ / normConstant;
+    result.dw = lattice.derivW / normConstant;
+    return result;
+}
+
+/*
+ * 2D noise at one point for each of count contexts, out[i] being identical
+ * to noise2(contexts[i], x, y). The point is placed on the lattice and its
+ * vertices picked once, and only the hashing is done per context (see
+ * MultiSeedLattice).
+ */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::noise2Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T* out)
+{
+    const T normConstant = 47;
+
+    for (int i = 0; i < count; i++)
+        out[i] = 0;
+    noise2(MultiSeedLattice<T>(contexts, count, out), x, y);
+    for (int i = 0; i < count; i++)
+        out[i] /= normConstant;
+}
+
+/* 3D noise at one point for each of count contexts. See noise2Seeds. */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::noise3Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T z, T* out)
+{
+    const T normConstant = 103;
+
+    for (int i = 0; i < count; i++)
+        out[i] = 0;
+    noise3(MultiSeedLattice<T>(contexts, count, out), x, y, z);
+    for (int i = 0; i < count; i++)
+        out[i] /= normConstant;
+}
+
+/* 4D noise at one point for each of count contexts. See noise2Seeds. */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::noise4Seeds(OPENSIMPLEX_GPU_CONSTANT const Context* contexts, int count, T x, T y, T z, T w, T* out)
+{
+    const T normConstant = 30;
+
+    for (int i = 0; i < count; i++)
+        out[i] = 0;
+    noise4(MultiSeedLattice<T>(contexts, count, out), x, y, z, w);
+    for (int i = 0; i < count; i++)
+        out[i] /= normConstant;
+}
+
+/*
+ * 2D noise that repeats every periodX lattice steps along the lattice x axis
+ * and every periodY along the lattice y axis (see PeriodicLattice). The
+ * lattice is skewed, so in input space the value repeats along the vectors
+ * periodX * (1 + s, s) and periodY * (s, 1 + s), where s = (sqrt(3) - 1) / 2,
+ * rather than along x and y. Wrapping takes an integer division per vertex
+ * coordinate, so this costs about 1.25 times as much as noise2.
+ */
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise2Periodic(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int periodX, int periodY, T x, T y)
+{
+    return noise2(PeriodicLattice(ctx, periodX, periodY), x, y);
+}
+
+/*
+ * 3D noise that repeats every period lattice steps along each lattice axis.
+ * In input space it repeats along periodX * (4/3, 1/3, 1/3) and the matching
+ * vectors for y and z. See noise2Periodic. With more vertices to wrap, this
+ * costs about 1.7 times as much as noise3.
+ */
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise3Periodic(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int periodX, int periodY, int periodZ, T x, T y, T z)
+{
+    return noise3(PeriodicLattice(ctx, periodX, periodY, periodZ), x, y, z);
+}
+
+#if !OPENSIMPLEX_IS_GPU
+
+/*
+ * Fills out with a width x height raster of 2D noise, row by row, where
+ * out[j * width + i] = noise2(context, originX + i * stepX, originY + j * stepY).
+ * The raster is walked in tiles. When a tile holds more samples than there
+ * are lattice vertices around it, their gradients are resolved once up front
+ * and shared by all of its samples; sparser tiles hash per sample as noise2
+ * does. Either way the values are identical to noise2's.
+ */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::fillGrid2(const Context& context, T* out, T originX, T originY,
+                      T stepX, T stepY, int width, int height)
+{
+    fillGridRegion2(context, out, originX, originY, stepX, stepY, width, 0, 0, width, height);
+}
+
+/*
+ * Fills only the samples [iBegin, iEnd) x [jBegin, jEnd) of the raster that
+ * fillGrid2 would fill, leaving the rest of out untouched. Disjoint regions
+ * can be filled concurrently.
+ */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::fillGridRegion2(const Context& context, T* out, T originX, T originY,
+                            T stepX, T stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd)
+{
+    storeGridRegion2(context, RasterStore<T>(out), originX, originY, stepX, stepY, width, iBegin, jBegin, iEnd, jEnd);
+}
+
+/*
+ * fillGridRegion2, handing each sample to store(index, i, j, value) rather
+ * than writing it to out[index].
+ */
+template <typename T, typename Index>
+template <typename Store>
+void BasicNoise<T, Index>::storeGridRegion2(const Context& context, const Store& store, T originX, T originY,
+                             T stepX, T stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd)
+{
+    const T stretchConstant = (T) -0.211324865405187; /* (1 / sqrt(2 + 1) - 1 ) / 2; */
+    const int tileWidth = 64;
+    const int tileHeight = 16;
+
+    ContextLattice hashed(context);
+    GridLattice grid(context);
+
+    for (int j0 = jBegin; j0 < jEnd; j0 += tileHeight) {
+        int j1 = j0 + tileHeight < jEnd ? j0 + tileHeight : jEnd;
+        for (int i0 = iBegin; i0 < iEnd; i0 += tileWidth) {
+            int i1 = i0 + tileWidth < iEnd ? i0 + tileWidth : iEnd;
+
+            /*
+             * Stretching is linear, so the super-cells of the tile are bounded
+             * by those of its corners. Vertices reach from -1 to +2 around a
+             * super-cell, and one more on each side absorbs rounding.
+             */
+            Index xsbMin = 0, ysbMin = 0, xsbMax = 0, ysbMax = 0;
+            for (int corner = 0; corner < 4; corner++) {
+                T x = originX + ((corner & 1) ? i1 - 1 : i0) * stepX;
+                T y = originY + ((corner & 2) ? j1 - 1 : j0) * stepY;
+                T stretchOffset = (x + y) * stretchConstant;
+                Index xsb = floor(x + stretchOffset);
+                Index ysb = floor(y + stretchOffset);
+                xsbMin = (corner == 0 || xsb < xsbMin) ? xsb : xsbMin;
+                ysbMin = (corner == 0 || ysb < ysbMin) ? ysb : ysbMin;
+                xsbMax = (corner == 0 || xsb > xsbMax) ? xsb : xsbMax;
+                ysbMax = (corner == 0 || ysb > ysbMax) ? ysb : ysbMax;
+            }
+            xsbMin -= 2; ysbMin -= 2;
+            xsbMax += 3; ysbMax += 3;
+
+            Index spanX = xsbMax - xsbMin + 1;
+            Index spanY = ysbMax - ysbMin + 1;
+            bool dense = spanX <= GridLattice::capacity && spanY <= GridLattice::capacity
+                && spanX * spanY <= (i1 - i0) * (j1 - j0) && spanX * spanY <= GridLattice::capacity;
+            if (dense) {
+                grid.cover2(xsbMin, ysbMin, xsbMax, ysbMax);
+                fillTile2(grid, store, originX, originY, stepX, stepY, width, i0, j0, i1, j1);
+            } else {
+                fillTile2(hashed, store, originX, originY, stepX, stepY, width, i0, j0, i1, j1);
+            }
+        }
+    }
+}
+
+/*
+ * Fills out with a width x height x depth raster of 3D noise, laid out as
+ * out[(k * height + j) * width + i]. Each slice is walked in tiles as in
+ * fillGrid2, and the values are identical to noise3's.
+ */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::fillGrid3(const Context& context, T* out, T originX, T originY, T originZ,
+                      T stepX, T stepY, T stepZ, int width, int height, int depth)
+{
+    fillGridRegion3(context, out, originX, originY, originZ, stepX, stepY, stepZ, width, height, 0, 0, 0, width, height, depth);
+}
+
+/*
+ * Fills only the samples [iBegin, iEnd) x [jBegin, jEnd) x [kBegin, kEnd) of
+ * the volume that fillGrid3 would fill. See fillGridRegion2.
+ */
+template <typename T, typename Index>
+void BasicNoise<T, Index>::fillGridRegion3(const Context& context, T* out, T originX, T originY, T originZ,
+                            T stepX, T stepY, T stepZ, int width, int height,
+                            int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd)
+{
+    storeGridRegion3(context, RasterStore<T>(out), originX, originY, originZ, stepX, stepY, stepZ, width, height,
+                     iBegin, jBegin, kBegin, iEnd, jEnd, kEnd);
+}
+
+/* fillGridRegion3 through a store. See storeGridRegion2. */
+template <typename T, typename Index>
+template <typename Store>
+void BasicNoise<T, Index>::storeGridRegion3(const Context& context, const Store& store, T originX, T originY, T originZ,
+                             T stepX, T stepY, T stepZ, int width, int height,
+                             int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd)
+{
+    const T stretchConstant = (T) -1 / (T) 6; /* (1 / sqrt(3 + 1) - 1) / 3; */
+    const int tileWidth = 64;
+    const int tileHeight = 16;
+
+    ContextLattice hashed(context);
+    GridLattice grid(context);
+
+    for (int k = kBegin; k < kEnd; k++) {
+        T z = originZ + k * stepZ;
+        size_t slice = (size_t) k * width * height;
+        for (int j0 = jBegin; j0 < jEnd; j0 += tileHeight) {
+            int j1 = j0 + tileHeight < jEnd ? j0 + tileHeight : jEnd;
+            for (int i0 = iBegin; i0 < iEnd; i0 += tileWidth) {
+                int i1 = i0 + tileWidth < iEnd ? i0 + tileWidth : iEnd;
+
+                /* Bounds of the tile's vertices, as in fillGrid2. */
+                Index xsbMin = 0, ysbMin = 0, zsbMin = 0, xsbMax = 0, ysbMax = 0, zsbMax = 0;
+                for (int corner = 0; corner < 4; corner++) {
+                    T x = originX + ((corner & 1) ? i1 - 1 : i0) * stepX;
+                    T y = originY + ((corner & 2) ? j1 - 1 : j0) * stepY;
+                    T stretchOffset = (x + y + z) * stretchConstant;
+                    Index xsb = floor(x + stretchOffset);
+                    Index ysb = floor(y + stretchOffset);
+                    Index zsb = floor(z + stretchOffset);
+                    xsbMin = (corner == 0 || xsb < xsbMin) ? xsb : xsbMin;
+                    ysbMin = (corner == 0 || ysb < ysbMin) ? ysb : ysbMin;
+                    zsbMin = (corner == 0 || zsb < zsbMin) ? zsb : zsbMin;
+                    xsbMax = (corner == 0 || xsb > xsbMax) ? xsb : xsbMax;
+                    ysbMax = (corner == 0 || ysb > ysbMax) ? ysb : ysbMax;
+                    zsbMax = (corner == 0 || zsb > zsbMax) ? zsb : zsbMax;
+                }
+                xsbMin -= 2; ysbMin -= 2; zsbMin -= 2;
+                xsbMax += 3; ysbMax += 3; zsbMax += 3;
+
+                Index spanX = xsbMax - xsbMin + 1;
+                Index spanY = ysbMax - ysbMin + 1;
+                Index spanZ = zsbMax - zsbMin + 1;
+                bool dense = spanX <= GridLattice::capacity && spanY <= GridLattice::capacity && spanZ <= GridLattice::capacity
+                    && spanX * spanY * spanZ <= (i1 - i0) * (j1 - j0) && spanX * spanY * spanZ <= GridLattice::capacity;
+                if (dense) {
+                    grid.cover3(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+                    fillTile3(grid, store, slice, originX, originY, z, stepX, stepY, width, i0, j0, i1, j1);
+                } else {
+                    fillTile3(hashed, store, slice, originX, originY, z, stepX, stepY, width, i0, j0, i1, j1);
+                }
+            }
+        }
+    }
+}
+
+/* Fills the samples [i0, i1) x [j0, j1) of a raster of 2D noise. */
+template <typename T, typename Index>
+template <typename Lattice, typename Store>
+void BasicNoise<T, Index>::fillTile2(const Lattice& lattice, const Store& store, T originX, T originY,
+                      T stepX, T stepY, int width, int i0, int j0, int i1, int j1)
+{
+    for (int j = j0; j < j1; j++) {
+        T y = originY + j * stepY;
+        size_t row = (size_t) j * width;
+        for (int i = i0; i < i1; i++)
+            store(row + i, i, j, noise2(lattice, originX + i * stepX, y));
+    }
+}
+
+/* Fills the samples [i0, i1) x [j0, j1) of a slice of 3D noise at z, starting at offset. */
+template <typename T, typename Index>
+template <typename Lattice, typename Store>
+void BasicNoise<T, Index>::fillTile3(const Lattice& lattice, const Store& store, size_t offset, T originX, T originY, T z,
+                      T stepX, T stepY, int width, int i0, int j0, int i1, int j1)
+{
+    for (int j = j0; j < j1; j++) {
+        T y = originY + j * stepY;
+        size_t row = offset + (size_t) j * width;
+        for (int i = i0; i < i1; i++)
+            store(row + i, i, j, noise3(lattice, originX + i * stepX, y, z));
+    }
+}
+
+#endif
+
+/*
+ * 2D OpenSimplex (Simplectic) Noise, with vertex gradients from lattice.
+ */
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::noise2(const Lattice& lattice, T x, T y)
+{
+    const T stretchConstant = (T) -0.211324865405187; /* (1 / sqrt(2 + 1) - 1 ) / 2; */
+    const T squishConstant = (T) 0.366025403784439; /* (sqrt(2 + 1) -1) / 2; */
+    const T normConstant = 47;
 
     /* Place input coordinates onto grid. */
-    float stretchOffset = (x + y) * stretchConstant;
-    float xs = x + stretchOffset;
-    float ys = y + stretchOffset;
+    T stretchOffset = (x + y) * stretchConstant;
+    T xs = x + stretchOffset;
+    T ys = y + stretchOffset;
 
     /* Floor to get grid coordinates of rhombus (stretched square) super-cell origin. */
-    int xsb = floor(xs);
-    int ysb = floor(ys);
+    Index xsb = floor(xs);
+    Index ysb = floor(ys);
 
     /* Skew out to get actual coordinates of rhombus origin. We'll need these later. */
-    float squishOffset = (xsb + ysb) * squishConstant;
-    float xb = xsb + squishOffset;
-    float yb = ysb + squishOffset;
+    T squishOffset = (xsb + ysb) * squishConstant;
+    T xb = xsb + squishOffset;
+    T yb = ysb + squishOffset;
 
     /* Compute grid coordinates relative to rhombus origin. */
-    float xins = xs - xsb;
-    float yins = ys - ysb;
+    T xins = xs - xsb;
+    T yins = ys - ysb;
 
     /* Sum those together to get a value that determines which region we're in. */
-    float inSum = xins + yins;
+    T inSum = xins + yins;
 
     /* Positions relative to origin point. */
-    float dx0 = x - xb;
-    float dy0 = y - yb;
+    T dx0 = x - xb;
+    T dy0 = y - yb;
 
     /* We'll be defining these inside the next block and using them afterwards. */
-    float dx_ext, dy_ext;
-    int xsv_ext, ysv_ext;
+    T dx_ext, dy_ext;
+    Index xsv_ext, ysv_ext;
 
-    float dx1;
-    float dy1;
-    float attn1;
-    float dx2;
-    float dy2;
-    float attn2;
-    float zins;
-    float attn0;
-    float attn_ext;
+    T dx1;
+    T dy1;
+    T attn1;
+    T dx2;
+    T dy2;
+    T attn2;
+    T zins;
+    T attn0;
+    T attn_ext;
 
-    float value = 0;
+    T value = 0;
 
     /* Contribution (1,0) */
     dx1 = dx0 - 1 - squishConstant;
@@ -105,7 +604,7 @@ float Noise::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     attn1 = 2 - dx1 * dx1 - dy1 * dy1;
     if (attn1 > 0) {
         attn1 *= attn1;
-        value += attn1 * attn1 * extrapolate2(ctx, xsb + 1, ysb + 0, dx1, dy1);
+        value += attn1 * attn1 * lattice.extrapolate2(xsb + 1, ysb + 0, dx1, dy1);
     }
 
     /* Contribution (0,1) */
@@ -114,7 +613,7 @@ float Noise::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     attn2 = 2 - dx2 * dx2 - dy2 * dy2;
     if (attn2 > 0) {
         attn2 *= attn2;
-        value += attn2 * attn2 * extrapolate2(ctx, xsb + 0, ysb + 1, dx2, dy2);
+        value += attn2 * attn2 * lattice.extrapolate2(xsb + 0, ysb + 1, dx2, dy2);
     }
 
     if (inSum <= 1) { /* We're inside the triangle (2-Simplex) at (0,0) */
@@ -167,82 +666,84 @@ float Noise::noise2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     attn0 = 2 - dx0 * dx0 - dy0 * dy0;
     if (attn0 > 0) {
         attn0 *= attn0;
-        value += attn0 * attn0 * extrapolate2(ctx, xsb, ysb, dx0, dy0);
+        value += attn0 * attn0 * lattice.extrapolate2(xsb, ysb, dx0, dy0);
     }
 
     /* Extra Vertex */
     attn_ext = 2 - dx_ext * dx_ext - dy_ext * dy_ext;
     if (attn_ext > 0) {
         attn_ext *= attn_ext;
-        value += attn_ext * attn_ext * extrapolate2(ctx, xsv_ext, ysv_ext, dx_ext, dy_ext);
+        value += attn_ext * attn_ext * lattice.extrapolate2(xsv_ext, ysv_ext, dx_ext, dy_ext);
     }
 
     return value / normConstant;
 }
 
 /*
- * 3D OpenSimplex (Simplectic) Noise
+ * 3D OpenSimplex (Simplectic) Noise, with vertex gradients from lattice.
  */
-float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float y, float z)
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::noise3(const Lattice& lattice, T x, T y, T z)
 {
-    const float stretchConstant = (-1.0f / 6.0f); /* (1 / sqrt(3 + 1) - 1) / 3; */
-    const float squishConstant = (1.0f / 3.0f); /* (sqrt(3+1)-1)/3; */
-    const float normConstant = 103.0f;
+    const T stretchConstant = (T) -1 / (T) 6; /* (1 / sqrt(3 + 1) - 1) / 3; */
+    const T squishConstant = (T) 1 / (T) 3; /* (sqrt(3+1)-1)/3; */
+    const T normConstant = 103;
 
     /* Place input coordinates on simplectic honeycomb. */
-    float stretchOffset = (x + y + z) * stretchConstant;
-    float xs = x + stretchOffset;
-    float ys = y + stretchOffset;
-    float zs = z + stretchOffset;
+    T stretchOffset = (x + y + z) * stretchConstant;
+    T xs = x + stretchOffset;
+    T ys = y + stretchOffset;
+    T zs = z + stretchOffset;
 
     /* Floor to get simplectic honeycomb coordinates of rhombohedron (stretched cube) super-cell origin. */
-    int xsb = floor(xs);
-    int ysb = floor(ys);
-    int zsb = floor(zs);
+    Index xsb = floor(xs);
+    Index ysb = floor(ys);
+    Index zsb = floor(zs);
 
     /* Skew out to get actual coordinates of rhombohedron origin. We'll need these later. */
-    float squishOffset = (xsb + ysb + zsb) * squishConstant;
-    float xb = xsb + squishOffset;
-    float yb = ysb + squishOffset;
-    float zb = zsb + squishOffset;
+    T squishOffset = (xsb + ysb + zsb) * squishConstant;
+    T xb = xsb + squishOffset;
+    T yb = ysb + squishOffset;
+    T zb = zsb + squishOffset;
 
     /* Compute simplectic honeycomb coordinates relative to rhombohedral origin. */
-    float xins = xs - xsb;
-    float yins = ys - ysb;
-    float zins = zs - zsb;
+    T xins = xs - xsb;
+    T yins = ys - ysb;
+    T zins = zs - zsb;
 
     /* Sum those together to get a value that determines which region we're in. */
-    float inSum = xins + yins + zins;
+    T inSum = xins + yins + zins;
 
     /* Positions relative to origin point. */
-    float dx0 = x - xb;
-    float dy0 = y - yb;
-    float dz0 = z - zb;
+    T dx0 = x - xb;
+    T dy0 = y - yb;
+    T dz0 = z - zb;
 
     /* We'll be defining these inside the next block and using them afterwards. */
-    float dx_ext0, dy_ext0, dz_ext0;
-    float dx_ext1, dy_ext1, dz_ext1;
-    int xsv_ext0, ysv_ext0, zsv_ext0;
-    int xsv_ext1, ysv_ext1, zsv_ext1;
+    T dx_ext0, dy_ext0, dz_ext0;
+    T dx_ext1, dy_ext1, dz_ext1;
+    Index xsv_ext0, ysv_ext0, zsv_ext0;
+    Index xsv_ext1, ysv_ext1, zsv_ext1;
 
-    float wins;
+    T wins;
     int8_t c, c1, c2;
     int8_t aPoint, bPoint;
-    float aScore, bScore;
+    T aScore, bScore;
     int aIsFurtherSide;
     int bIsFurtherSide;
-    float p1, p2, p3;
-    float score;
-    float attn0, attn1, attn2, attn3, attn4, attn5, attn6;
-    float dx1, dy1, dz1;
-    float dx2, dy2, dz2;
-    float dx3, dy3, dz3;
-    float dx4, dy4, dz4;
-    float dx5, dy5, dz5;
-    float dx6, dy6, dz6;
-    float attn_ext0, attn_ext1;
-
-    float value = 0;
+    T p1, p2, p3;
+    T score;
+    T attn0, attn1, attn2, attn3, attn4, attn5, attn6;
+    T dx1, dy1, dz1;
+    T dx2, dy2, dz2;
+    T dx3, dy3, dz3;
+    T dx4, dy4, dz4;
+    T dx5, dy5, dz5;
+    T dx6, dy6, dz6;
+    T attn_ext0, attn_ext1;
+
+    T value = 0;
     if (inSum <= 1) { /* We're inside the tetrahedron (3-Simplex) at (0,0,0) */
 
         /* Determine which two of (0,0,1), (0,1,0), (1,0,0) are closest. */
@@ -339,7 +840,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn0 = 2 - dx0 * dx0 - dy0 * dy0 - dz0 * dz0;
         if (attn0 > 0) {
             attn0 *= attn0;
-            value += attn0 * attn0 * extrapolate3(ctx, xsb + 0, ysb + 0, zsb + 0, dx0, dy0, dz0);
+            value += attn0 * attn0 * lattice.extrapolate3(xsb + 0, ysb + 0, zsb + 0, dx0, dy0, dz0);
         }
 
         /* Contribution (1,0,0) */
@@ -349,7 +850,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate3(ctx, xsb + 1, ysb + 0, zsb + 0, dx1, dy1, dz1);
+            value += attn1 * attn1 * lattice.extrapolate3(xsb + 1, ysb + 0, zsb + 0, dx1, dy1, dz1);
         }
 
         /* Contribution (0,1,0) */
@@ -359,7 +860,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate3(ctx, xsb + 0, ysb + 1, zsb + 0, dx2, dy2, dz2);
+            value += attn2 * attn2 * lattice.extrapolate3(xsb + 0, ysb + 1, zsb + 0, dx2, dy2, dz2);
         }
 
         /* Contribution (0,0,1) */
@@ -369,7 +870,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate3(ctx, xsb + 0, ysb + 0, zsb + 1, dx3, dy3, dz3);
+            value += attn3 * attn3 * lattice.extrapolate3(xsb + 0, ysb + 0, zsb + 1, dx3, dy3, dz3);
         }
     } else if (inSum >= 2) { /* We're inside the tetrahedron (3-Simplex) at (1,1,1) */
 
@@ -470,7 +971,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate3(ctx, xsb + 1, ysb + 1, zsb + 0, dx3, dy3, dz3);
+            value += attn3 * attn3 * lattice.extrapolate3(xsb + 1, ysb + 1, zsb + 0, dx3, dy3, dz3);
         }
 
         /* Contribution (1,0,1) */
@@ -480,7 +981,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate3(ctx, xsb + 1, ysb + 0, zsb + 1, dx2, dy2, dz2);
+            value += attn2 * attn2 * lattice.extrapolate3(xsb + 1, ysb + 0, zsb + 1, dx2, dy2, dz2);
         }
 
         /* Contribution (0,1,1) */
@@ -490,7 +991,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate3(ctx, xsb + 0, ysb + 1, zsb + 1, dx1, dy1, dz1);
+            value += attn1 * attn1 * lattice.extrapolate3(xsb + 0, ysb + 1, zsb + 1, dx1, dy1, dz1);
         }
 
         /* Contribution (1,1,1) */
@@ -500,7 +1001,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn0 = 2 - dx0 * dx0 - dy0 * dy0 - dz0 * dz0;
         if (attn0 > 0) {
             attn0 *= attn0;
-            value += attn0 * attn0 * extrapolate3(ctx, xsb + 1, ysb + 1, zsb + 1, dx0, dy0, dz0);
+            value += attn0 * attn0 * lattice.extrapolate3(xsb + 1, ysb + 1, zsb + 1, dx0, dy0, dz0);
         }
     } else { /* We're inside the octahedron (Rectified 3-Simplex) in between.
               Decide between point (0,0,1) and (1,1,0) as closest */
@@ -683,7 +1184,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate3(ctx, xsb + 1, ysb + 0, zsb + 0, dx1, dy1, dz1);
+            value += attn1 * attn1 * lattice.extrapolate3(xsb + 1, ysb + 0, zsb + 0, dx1, dy1, dz1);
         }
 
         /* Contribution (0,1,0) */
@@ -693,7 +1194,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate3(ctx, xsb + 0, ysb + 1, zsb + 0, dx2, dy2, dz2);
+            value += attn2 * attn2 * lattice.extrapolate3(xsb + 0, ysb + 1, zsb + 0, dx2, dy2, dz2);
         }
 
         /* Contribution (0,0,1) */
@@ -703,7 +1204,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate3(ctx, xsb + 0, ysb + 0, zsb + 1, dx3, dy3, dz3);
+            value += attn3 * attn3 * lattice.extrapolate3(xsb + 0, ysb + 0, zsb + 1, dx3, dy3, dz3);
         }
 
         /* Contribution (1,1,0) */
@@ -713,7 +1214,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn4 = 2 - dx4 * dx4 - dy4 * dy4 - dz4 * dz4;
         if (attn4 > 0) {
             attn4 *= attn4;
-            value += attn4 * attn4 * extrapolate3(ctx, xsb + 1, ysb + 1, zsb + 0, dx4, dy4, dz4);
+            value += attn4 * attn4 * lattice.extrapolate3(xsb + 1, ysb + 1, zsb + 0, dx4, dy4, dz4);
         }
 
         /* Contribution (1,0,1) */
@@ -723,7 +1224,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn5 = 2 - dx5 * dx5 - dy5 * dy5 - dz5 * dz5;
         if (attn5 > 0) {
             attn5 *= attn5;
-            value += attn5 * attn5 * extrapolate3(ctx, xsb + 1, ysb + 0, zsb + 1, dx5, dy5, dz5);
+            value += attn5 * attn5 * lattice.extrapolate3(xsb + 1, ysb + 0, zsb + 1, dx5, dy5, dz5);
         }
 
         /* Contribution (0,1,1) */
@@ -733,7 +1234,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn6 = 2 - dx6 * dx6 - dy6 * dy6 - dz6 * dz6;
         if (attn6 > 0) {
             attn6 *= attn6;
-            value += attn6 * attn6 * extrapolate3(ctx, xsb + 0, ysb + 1, zsb + 1, dx6, dy6, dz6);
+            value += attn6 * attn6 * lattice.extrapolate3(xsb + 0, ysb + 1, zsb + 1, dx6, dy6, dz6);
         }
     }
 
@@ -742,7 +1243,7 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     if (attn_ext0 > 0)
     {
         attn_ext0 *= attn_ext0;
-        value += attn_ext0 * attn_ext0 * extrapolate3(ctx, xsv_ext0, ysv_ext0, zsv_ext0, dx_ext0, dy_ext0, dz_ext0);
+        value += attn_ext0 * attn_ext0 * lattice.extrapolate3(xsv_ext0, ysv_ext0, zsv_ext0, dx_ext0, dy_ext0, dz_ext0);
     }
 
     /* Second extra vertex */
@@ -750,87 +1251,89 @@ float Noise::noise3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     if (attn_ext1 > 0)
     {
         attn_ext1 *= attn_ext1;
-        value += attn_ext1 * attn_ext1 * extrapolate3(ctx, xsv_ext1, ysv_ext1, zsv_ext1, dx_ext1, dy_ext1, dz_ext1);
+        value += attn_ext1 * attn_ext1 * lattice.extrapolate3(xsv_ext1, ysv_ext1, zsv_ext1, dx_ext1, dy_ext1, dz_ext1);
     }
 
     return value / normConstant;
 }
 
 /*
- * 4D OpenSimplex (Simplectic) Noise.
+ * 4D OpenSimplex (Simplectic) Noise, with vertex gradients from lattice.
  */
-float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float y, float z, float w)
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::noise4(const Lattice& lattice, T x, T y, T z, T w)
 {
-    const float stretchConstant = -0.138196601125011f; /* (1 / sqrt(4 + 1) - 1) / 4; */
-    const float squishConstant = 0.309016994374947f; /* (sqrt(4 + 1) - 1) / 4; */
-    const float normConstant = 30.0f;
-
-    float uins;
-    float dx1, dy1, dz1, dw1;
-    float dx2, dy2, dz2, dw2;
-    float dx3, dy3, dz3, dw3;
-    float dx4, dy4, dz4, dw4;
-    float dx5, dy5, dz5, dw5;
-    float dx6, dy6, dz6, dw6;
-    float dx7, dy7, dz7, dw7;
-    float dx8, dy8, dz8, dw8;
-    float dx9, dy9, dz9, dw9;
-    float dx10, dy10, dz10, dw10;
-    float attn0, attn1, attn2, attn3, attn4;
-    float attn5, attn6, attn7, attn8, attn9, attn10;
-    float attn_ext0, attn_ext1, attn_ext2;
+    const T stretchConstant = (T) -0.138196601125011; /* (1 / sqrt(4 + 1) - 1) / 4; */
+    const T squishConstant = (T) 0.309016994374947; /* (sqrt(4 + 1) - 1) / 4; */
+    const T normConstant = 30;
+
+    T uins;
+    T dx1, dy1, dz1, dw1;
+    T dx2, dy2, dz2, dw2;
+    T dx3, dy3, dz3, dw3;
+    T dx4, dy4, dz4, dw4;
+    T dx5, dy5, dz5, dw5;
+    T dx6, dy6, dz6, dw6;
+    T dx7, dy7, dz7, dw7;
+    T dx8, dy8, dz8, dw8;
+    T dx9, dy9, dz9, dw9;
+    T dx10, dy10, dz10, dw10;
+    T attn0, attn1, attn2, attn3, attn4;
+    T attn5, attn6, attn7, attn8, attn9, attn10;
+    T attn_ext0, attn_ext1, attn_ext2;
     int8_t c, c1, c2;
     int8_t aPoint, bPoint;
-    float aScore, bScore;
+    T aScore, bScore;
     int aIsBiggerSide;
     int bIsBiggerSide;
-    float p1, p2, p3, p4;
-    float score;
+    T p1, p2, p3, p4;
+    T score;
 
     /* Place input coordinates on simplectic honeycomb. */
-    float stretchOffset = (x + y + z + w) * stretchConstant;
-    float xs = x + stretchOffset;
-    float ys = y + stretchOffset;
-    float zs = z + stretchOffset;
-    float ws = w + stretchOffset;
+    T stretchOffset = (x + y + z + w) * stretchConstant;
+    T xs = x + stretchOffset;
+    T ys = y + stretchOffset;
+    T zs = z + stretchOffset;
+    T ws = w + stretchOffset;
 
     /* Floor to get simplectic honeycomb coordinates of rhombo-hypercube super-cell origin. */
-    int xsb = floor(xs);
-    int ysb = floor(ys);
-    int zsb = floor(zs);
-    int wsb = floor(ws);
+    Index xsb = floor(xs);
+    Index ysb = floor(ys);
+    Index zsb = floor(zs);
+    Index wsb = floor(ws);
 
     /* Skew out to get actual coordinates of stretched rhombo-hypercube origin. We'll need these later. */
-    float squishOffset = (xsb + ysb + zsb + wsb) * squishConstant;
-    float xb = xsb + squishOffset;
-    float yb = ysb + squishOffset;
-    float zb = zsb + squishOffset;
-    float wb = wsb + squishOffset;
+    T squishOffset = (xsb + ysb + zsb + wsb) * squishConstant;
+    T xb = xsb + squishOffset;
+    T yb = ysb + squishOffset;
+    T zb = zsb + squishOffset;
+    T wb = wsb + squishOffset;
 
     /* Compute simplectic honeycomb coordinates relative to rhombo-hypercube origin. */
-    float xins = xs - xsb;
-    float yins = ys - ysb;
-    float zins = zs - zsb;
-    float wins = ws - wsb;
+    T xins = xs - xsb;
+    T yins = ys - ysb;
+    T zins = zs - zsb;
+    T wins = ws - wsb;
 
     /* Sum those together to get a value that determines which region we're in. */
-    float inSum = xins + yins + zins + wins;
+    T inSum = xins + yins + zins + wins;
 
     /* Positions relative to origin point. */
-    float dx0 = x - xb;
-    float dy0 = y - yb;
-    float dz0 = z - zb;
-    float dw0 = w - wb;
+    T dx0 = x - xb;
+    T dy0 = y - yb;
+    T dz0 = z - zb;
+    T dw0 = w - wb;
 
     /* We'll be defining these inside the next block and using them afterwards. */
-    float dx_ext0, dy_ext0, dz_ext0, dw_ext0;
-    float dx_ext1, dy_ext1, dz_ext1, dw_ext1;
-    float dx_ext2, dy_ext2, dz_ext2, dw_ext2;
-    int xsv_ext0, ysv_ext0, zsv_ext0, wsv_ext0;
-    int xsv_ext1, ysv_ext1, zsv_ext1, wsv_ext1;
-    int xsv_ext2, ysv_ext2, zsv_ext2, wsv_ext2;
-
-    float value = 0;
+    T dx_ext0, dy_ext0, dz_ext0, dw_ext0;
+    T dx_ext1, dy_ext1, dz_ext1, dw_ext1;
+    T dx_ext2, dy_ext2, dz_ext2, dw_ext2;
+    Index xsv_ext0, ysv_ext0, zsv_ext0, wsv_ext0;
+    Index xsv_ext1, ysv_ext1, zsv_ext1, wsv_ext1;
+    Index xsv_ext2, ysv_ext2, zsv_ext2, wsv_ext2;
+
+    T value = 0;
     if (inSum <= 1) { /* We're inside the pentachoron (4-Simplex) at (0,0,0,0) */
 
         /* Determine which two of (0,0,0,1), (0,0,1,0), (0,1,0,0), (1,0,0,0) are closest. */
@@ -978,7 +1481,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn0 = 2 - dx0 * dx0 - dy0 * dy0 - dz0 * dz0 - dw0 * dw0;
         if (attn0 > 0) {
             attn0 *= attn0;
-            value += attn0 * attn0 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 0, wsb + 0, dx0, dy0, dz0, dw0);
+            value += attn0 * attn0 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 0, wsb + 0, dx0, dy0, dz0, dw0);
         }
 
         /* Contribution (1,0,0,0) */
@@ -989,7 +1492,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1 - dw1 * dw1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 0, wsb + 0, dx1, dy1, dz1, dw1);
+            value += attn1 * attn1 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 0, wsb + 0, dx1, dy1, dz1, dw1);
         }
 
         /* Contribution (0,1,0,0) */
@@ -1000,7 +1503,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2 - dw2 * dw2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 0, wsb + 0, dx2, dy2, dz2, dw2);
+            value += attn2 * attn2 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 0, wsb + 0, dx2, dy2, dz2, dw2);
         }
 
         /* Contribution (0,0,1,0) */
@@ -1011,7 +1514,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3 - dw3 * dw3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 1, wsb + 0, dx3, dy3, dz3, dw3);
+            value += attn3 * attn3 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 1, wsb + 0, dx3, dy3, dz3, dw3);
         }
 
         /* Contribution (0,0,0,1) */
@@ -1022,7 +1525,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn4 = 2 - dx4 * dx4 - dy4 * dy4 - dz4 * dz4 - dw4 * dw4;
         if (attn4 > 0) {
             attn4 *= attn4;
-            value += attn4 * attn4 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 0, wsb + 1, dx4, dy4, dz4, dw4);
+            value += attn4 * attn4 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 0, wsb + 1, dx4, dy4, dz4, dw4);
         }
     } else if (inSum >= 3) { /* We're inside the pentachoron (4-Simplex) at (1,1,1,1)
                               Determine which two of (1,1,1,0), (1,1,0,1), (1,0,1,1), (0,1,1,1) are closest. */
@@ -1175,7 +1678,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn4 = 2 - dx4 * dx4 - dy4 * dy4 - dz4 * dz4 - dw4 * dw4;
         if (attn4 > 0) {
             attn4 *= attn4;
-            value += attn4 * attn4 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 1, wsb + 0, dx4, dy4, dz4, dw4);
+            value += attn4 * attn4 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 1, wsb + 0, dx4, dy4, dz4, dw4);
         }
 
         /* Contribution (1,1,0,1) */
@@ -1186,7 +1689,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3 - dw3 * dw3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 0, wsb + 1, dx3, dy3, dz3, dw3);
+            value += attn3 * attn3 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 0, wsb + 1, dx3, dy3, dz3, dw3);
         }
 
         /* Contribution (1,0,1,1) */
@@ -1197,7 +1700,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2 - dw2 * dw2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 1, wsb + 1, dx2, dy2, dz2, dw2);
+            value += attn2 * attn2 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 1, wsb + 1, dx2, dy2, dz2, dw2);
         }
 
         /* Contribution (0,1,1,1) */
@@ -1208,7 +1711,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1 - dw1 * dw1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 1, wsb + 1, dx1, dy1, dz1, dw1);
+            value += attn1 * attn1 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 1, wsb + 1, dx1, dy1, dz1, dw1);
         }
 
         /* Contribution (1,1,1,1) */
@@ -1219,7 +1722,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn0 = 2 - dx0 * dx0 - dy0 * dy0 - dz0 * dz0 - dw0 * dw0;
         if (attn0 > 0) {
             attn0 *= attn0;
-            value += attn0 * attn0 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 1, wsb + 1, dx0, dy0, dz0, dw0);
+            value += attn0 * attn0 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 1, wsb + 1, dx0, dy0, dz0, dw0);
         }
     } else if (inSum <= 2) { /* We're inside the first dispentachoron (Rectified 4-Simplex) */
         aIsBiggerSide = 1;
@@ -1544,7 +2047,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1 - dw1 * dw1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 0, wsb + 0, dx1, dy1, dz1, dw1);
+            value += attn1 * attn1 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 0, wsb + 0, dx1, dy1, dz1, dw1);
         }
 
         /* Contribution (0,1,0,0) */
@@ -1555,7 +2058,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2 - dw2 * dw2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 0, wsb + 0, dx2, dy2, dz2, dw2);
+            value += attn2 * attn2 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 0, wsb + 0, dx2, dy2, dz2, dw2);
         }
 
         /* Contribution (0,0,1,0) */
@@ -1566,7 +2069,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3 - dw3 * dw3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 1, wsb + 0, dx3, dy3, dz3, dw3);
+            value += attn3 * attn3 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 1, wsb + 0, dx3, dy3, dz3, dw3);
         }
 
         /* Contribution (0,0,0,1) */
@@ -1577,7 +2080,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn4 = 2 - dx4 * dx4 - dy4 * dy4 - dz4 * dz4 - dw4 * dw4;
         if (attn4 > 0) {
             attn4 *= attn4;
-            value += attn4 * attn4 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 0, wsb + 1, dx4, dy4, dz4, dw4);
+            value += attn4 * attn4 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 0, wsb + 1, dx4, dy4, dz4, dw4);
         }
 
         /* Contribution (1,1,0,0) */
@@ -1588,7 +2091,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn5 = 2 - dx5 * dx5 - dy5 * dy5 - dz5 * dz5 - dw5 * dw5;
         if (attn5 > 0) {
             attn5 *= attn5;
-            value += attn5 * attn5 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 0, wsb + 0, dx5, dy5, dz5, dw5);
+            value += attn5 * attn5 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 0, wsb + 0, dx5, dy5, dz5, dw5);
         }
 
         /* Contribution (1,0,1,0) */
@@ -1599,7 +2102,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn6 = 2 - dx6 * dx6 - dy6 * dy6 - dz6 * dz6 - dw6 * dw6;
         if (attn6 > 0) {
             attn6 *= attn6;
-            value += attn6 * attn6 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 1, wsb + 0, dx6, dy6, dz6, dw6);
+            value += attn6 * attn6 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 1, wsb + 0, dx6, dy6, dz6, dw6);
         }
 
         /* Contribution (1,0,0,1) */
@@ -1610,7 +2113,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn7 = 2 - dx7 * dx7 - dy7 * dy7 - dz7 * dz7 - dw7 * dw7;
         if (attn7 > 0) {
             attn7 *= attn7;
-            value += attn7 * attn7 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 0, wsb + 1, dx7, dy7, dz7, dw7);
+            value += attn7 * attn7 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 0, wsb + 1, dx7, dy7, dz7, dw7);
         }
 
         /* Contribution (0,1,1,0) */
@@ -1621,7 +2124,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn8 = 2 - dx8 * dx8 - dy8 * dy8 - dz8 * dz8 - dw8 * dw8;
         if (attn8 > 0) {
             attn8 *= attn8;
-            value += attn8 * attn8 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 1, wsb + 0, dx8, dy8, dz8, dw8);
+            value += attn8 * attn8 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 1, wsb + 0, dx8, dy8, dz8, dw8);
         }
 
         /* Contribution (0,1,0,1) */
@@ -1632,7 +2135,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn9 = 2 - dx9 * dx9 - dy9 * dy9 - dz9 * dz9 - dw9 * dw9;
         if (attn9 > 0) {
             attn9 *= attn9;
-            value += attn9 * attn9 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 0, wsb + 1, dx9, dy9, dz9, dw9);
+            value += attn9 * attn9 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 0, wsb + 1, dx9, dy9, dz9, dw9);
         }
 
         /* Contribution (0,0,1,1) */
@@ -1643,7 +2146,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn10 = 2 - dx10 * dx10 - dy10 * dy10 - dz10 * dz10 - dw10 * dw10;
         if (attn10 > 0) {
             attn10 *= attn10;
-            value += attn10 * attn10 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 1, wsb + 1, dx10, dy10, dz10, dw10);
+            value += attn10 * attn10 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 1, wsb + 1, dx10, dy10, dz10, dw10);
         }
     } else { /* We're inside the second dispentachoron (Rectified 4-Simplex) */
         aIsBiggerSide = 1;
@@ -1958,7 +2461,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn4 = 2 - dx4 * dx4 - dy4 * dy4 - dz4 * dz4 - dw4 * dw4;
         if (attn4 > 0) {
             attn4 *= attn4;
-            value += attn4 * attn4 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 1, wsb + 0, dx4, dy4, dz4, dw4);
+            value += attn4 * attn4 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 1, wsb + 0, dx4, dy4, dz4, dw4);
         }
 
         /* Contribution (1,1,0,1) */
@@ -1969,7 +2472,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn3 = 2 - dx3 * dx3 - dy3 * dy3 - dz3 * dz3 - dw3 * dw3;
         if (attn3 > 0) {
             attn3 *= attn3;
-            value += attn3 * attn3 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 0, wsb + 1, dx3, dy3, dz3, dw3);
+            value += attn3 * attn3 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 0, wsb + 1, dx3, dy3, dz3, dw3);
         }
 
         /* Contribution (1,0,1,1) */
@@ -1980,7 +2483,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn2 = 2 - dx2 * dx2 - dy2 * dy2 - dz2 * dz2 - dw2 * dw2;
         if (attn2 > 0) {
             attn2 *= attn2;
-            value += attn2 * attn2 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 1, wsb + 1, dx2, dy2, dz2, dw2);
+            value += attn2 * attn2 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 1, wsb + 1, dx2, dy2, dz2, dw2);
         }
 
         /* Contribution (0,1,1,1) */
@@ -1991,7 +2494,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn1 = 2 - dx1 * dx1 - dy1 * dy1 - dz1 * dz1 - dw1 * dw1;
         if (attn1 > 0) {
             attn1 *= attn1;
-            value += attn1 * attn1 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 1, wsb + 1, dx1, dy1, dz1, dw1);
+            value += attn1 * attn1 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 1, wsb + 1, dx1, dy1, dz1, dw1);
         }
 
         /* Contribution (1,1,0,0) */
@@ -2002,7 +2505,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn5 = 2 - dx5 * dx5 - dy5 * dy5 - dz5 * dz5 - dw5 * dw5;
         if (attn5 > 0) {
             attn5 *= attn5;
-            value += attn5 * attn5 * extrapolate4(ctx, xsb + 1, ysb + 1, zsb + 0, wsb + 0, dx5, dy5, dz5, dw5);
+            value += attn5 * attn5 * lattice.extrapolate4(xsb + 1, ysb + 1, zsb + 0, wsb + 0, dx5, dy5, dz5, dw5);
         }
 
         /* Contribution (1,0,1,0) */
@@ -2013,7 +2516,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn6 = 2 - dx6 * dx6 - dy6 * dy6 - dz6 * dz6 - dw6 * dw6;
         if (attn6 > 0) {
             attn6 *= attn6;
-            value += attn6 * attn6 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 1, wsb + 0, dx6, dy6, dz6, dw6);
+            value += attn6 * attn6 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 1, wsb + 0, dx6, dy6, dz6, dw6);
         }
 
         /* Contribution (1,0,0,1) */
@@ -2024,7 +2527,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn7 = 2 - dx7 * dx7 - dy7 * dy7 - dz7 * dz7 - dw7 * dw7;
         if (attn7 > 0) {
             attn7 *= attn7;
-            value += attn7 * attn7 * extrapolate4(ctx, xsb + 1, ysb + 0, zsb + 0, wsb + 1, dx7, dy7, dz7, dw7);
+            value += attn7 * attn7 * lattice.extrapolate4(xsb + 1, ysb + 0, zsb + 0, wsb + 1, dx7, dy7, dz7, dw7);
         }
 
         /* Contribution (0,1,1,0) */
@@ -2035,7 +2538,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn8 = 2 - dx8 * dx8 - dy8 * dy8 - dz8 * dz8 - dw8 * dw8;
         if (attn8 > 0) {
             attn8 *= attn8;
-            value += attn8 * attn8 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 1, wsb + 0, dx8, dy8, dz8, dw8);
+            value += attn8 * attn8 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 1, wsb + 0, dx8, dy8, dz8, dw8);
         }
 
         /* Contribution (0,1,0,1) */
@@ -2046,7 +2549,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn9 = 2 - dx9 * dx9 - dy9 * dy9 - dz9 * dz9 - dw9 * dw9;
         if (attn9 > 0) {
             attn9 *= attn9;
-            value += attn9 * attn9 * extrapolate4(ctx, xsb + 0, ysb + 1, zsb + 0, wsb + 1, dx9, dy9, dz9, dw9);
+            value += attn9 * attn9 * lattice.extrapolate4(xsb + 0, ysb + 1, zsb + 0, wsb + 1, dx9, dy9, dz9, dw9);
         }
 
         /* Contribution (0,0,1,1) */
@@ -2057,7 +2560,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
         attn10 = 2 - dx10 * dx10 - dy10 * dy10 - dz10 * dz10 - dw10 * dw10;
         if (attn10 > 0) {
             attn10 *= attn10;
-            value += attn10 * attn10 * extrapolate4(ctx, xsb + 0, ysb + 0, zsb + 1, wsb + 1, dx10, dy10, dz10, dw10);
+            value += attn10 * attn10 * lattice.extrapolate4(xsb + 0, ysb + 0, zsb + 1, wsb + 1, dx10, dy10, dz10, dw10);
         }
     }
 
@@ -2066,7 +2569,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     if (attn_ext0 > 0)
     {
         attn_ext0 *= attn_ext0;
-        value += attn_ext0 * attn_ext0 * extrapolate4(ctx, xsv_ext0, ysv_ext0, zsv_ext0, wsv_ext0, dx_ext0, dy_ext0, dz_ext0, dw_ext0);
+        value += attn_ext0 * attn_ext0 * lattice.extrapolate4(xsv_ext0, ysv_ext0, zsv_ext0, wsv_ext0, dx_ext0, dy_ext0, dz_ext0, dw_ext0);
     }
 
     /* Second extra vertex */
@@ -2074,7 +2577,7 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     if (attn_ext1 > 0)
     {
         attn_ext1 *= attn_ext1;
-        value += attn_ext1 * attn_ext1 * extrapolate4(ctx, xsv_ext1, ysv_ext1, zsv_ext1, wsv_ext1, dx_ext1, dy_ext1, dz_ext1, dw_ext1);
+        value += attn_ext1 * attn_ext1 * lattice.extrapolate4(xsv_ext1, ysv_ext1, zsv_ext1, wsv_ext1, dx_ext1, dy_ext1, dz_ext1, dw_ext1);
     }
 
     /* Third extra vertex */
@@ -2082,93 +2585,280 @@ float Noise::noise4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, float x, float
     if (attn_ext2 > 0)
     {
         attn_ext2 *= attn_ext2;
-        value += attn_ext2 * attn_ext2 * extrapolate4(ctx, xsv_ext2, ysv_ext2, zsv_ext2, wsv_ext2, dx_ext2, dy_ext2, dz_ext2, dw_ext2);
+        value += attn_ext2 * attn_ext2 * lattice.extrapolate4(xsv_ext2, ysv_ext2, zsv_ext2, wsv_ext2, dx_ext2, dy_ext2, dz_ext2, dw_ext2);
     }
 
     return value / normConstant;
 }
 
-float Noise::floor(float x)
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise3Table(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z)
 {
-    int xi = (int) x;
-    return x < xi ? xi - 1 : xi;
+    return noise3Table(ContextLattice(ctx), x, y, z);
+}
+
+/*
+ * 3D noise identical to noise3, bit for bit, without its branch tree: the
+ * region and extra vertex key come from the comparisons and selects of
+ * RegionClassifier::classify3, and every point then visits the six (padded)
+ * vertices of its region and its two extra vertices from VertexTables, so
+ * all points walk the same sequence of steps. The only branch left is the attenuation test
+ * on each vertex, which noise3 has as well.
+ */
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::noise3Table(const Lattice& lattice, T x, T y, T z)
+{
+    const T stretchConstant = (T) -1 / (T) 6; /* (1 / sqrt(3 + 1) - 1) / 3; */
+    const T squishConstant = (T) 1 / (T) 3; /* (sqrt(3+1)-1)/3; */
+    const T normConstant = 103;
+
+    /* Place input coordinates on simplectic honeycomb. */
+    T stretchOffset = (x + y + z) * stretchConstant;
+    T xs = x + stretchOffset;
+    T ys = y + stretchOffset;
+    T zs = z + stretchOffset;
+
+    /* Floor to get simplectic honeycomb coordinates of rhombohedron (stretched cube) super-cell origin. */
+    Index xsb = floor(xs);
+    Index ysb = floor(ys);
+    Index zsb = floor(zs);
+
+    /* Skew out to get actual coordinates of rhombohedron origin. */
+    T squishOffset = (xsb + ysb + zsb) * squishConstant;
+    T dx0 = x - (xsb + squishOffset);
+    T dy0 = y - (ysb + squishOffset);
+    T dz0 = z - (zsb + squishOffset);
+
+    /* Compute simplectic honeycomb coordinates relative to rhombohedral origin and the region selector. */
+    T xins = xs - xsb;
+    T yins = ys - ysb;
+    T zins = zs - zsb;
+    T inSum = xins + yins + zins;
+
+    int key = RegionClassifier::classify3(xins, yins, zins, inSum, (T) 1);
+    OPENSIMPLEX_GPU_CONSTANT const LatticeVertex* vertices = regionVertices3D[key >> 6];
+
+    T value = 0;
+    for (int k = 0; k < 6; k++)
+        value = contribution3(lattice, value, xsb, ysb, zsb, dx0, dy0, dz0, vertices[k]);
+
+    vertices = extraVertices3D[extraVertexIndex3D[key]];
+    for (int k = 0; k < 2; k++)
+        value = contribution3(lattice, value, xsb, ysb, zsb, dx0, dy0, dz0, vertices[k]);
+
+    return value / normConstant;
+}
+
+template <typename T, typename Index>
+T BasicNoise<T, Index>::noise4Table(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, T x, T y, T z, T w)
+{
+    return noise4Table(ContextLattice(ctx), x, y, z, w);
+}
+
+/*
+ * 4D noise identical to noise4, bit for bit, but with the contributing
+ * vertices looked up in VertexTables rather than picked by the branch tree.
+ * classify4 works out the region and extra vertex key with a handful of
+ * comparisons, and every vertex then goes through the same contribution4.
+ */
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::noise4Table(const Lattice& lattice, T x, T y, T z, T w)
+{
+    const T stretchConstant = (T) -0.138196601125011; /* (1 / sqrt(4 + 1) - 1) / 4; */
+    const T squishConstant = (T) 0.309016994374947; /* (sqrt(4 + 1) - 1) / 4; */
+    const T normConstant = 30;
+
+    /* Place input coordinates on simplectic honeycomb. */
+    T stretchOffset = (x + y + z + w) * stretchConstant;
+    T xs = x + stretchOffset;
+    T ys = y + stretchOffset;
+    T zs = z + stretchOffset;
+    T ws = w + stretchOffset;
+
+    /* Floor to get simplectic honeycomb coordinates of rhombo-hypercube super-cell origin. */
+    Index xsb = floor(xs);
+    Index ysb = floor(ys);
+    Index zsb = floor(zs);
+    Index wsb = floor(ws);
+
+    /* Skew out to get actual coordinates of stretched rhombo-hypercube origin. */
+    T squishOffset = (xsb + ysb + zsb + wsb) * squishConstant;
+    T dx0 = x - (xsb + squishOffset);
+    T dy0 = y - (ysb + squishOffset);
+    T dz0 = z - (zsb + squishOffset);
+    T dw0 = w - (wsb + squishOffset);
+
+    /* Compute simplectic honeycomb coordinates relative to rhombo-hypercube origin and the region selector. */
+    T xins = xs - xsb;
+    T yins = ys - ysb;
+    T zins = zs - zsb;
+    T wins = ws - wsb;
+    T inSum = xins + yins + zins + wins;
+
+    int key = classify4(xins, yins, zins, wins, inSum);
+    int region = key >> 8;
+
+    T value = 0;
+    for (int k = 0; k < regionVertexCount4D[region]; k++)
+        value = contribution4(lattice, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, regionVertices4D[region][k]);
+
+    int extra = extraVertexIndex4D[key];
+    for (int k = 0; k < 3; k++)
+        value = contribution4(lattice, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, extraVertices4D[extra][k]);
+
+    return value / normConstant;
+}
+
+/*
+ * The region noise4 would take for a point and the vertices it would find
+ * closest, as the extraVertexIndex4D key described in VertexTables.h.
+ */
+template <typename T, typename Index>
+int BasicNoise<T, Index>::classify4(T xins, T yins, T zins, T wins, T inSum)
+{
+    const int bigger = 0x10; /* Marks a point on the bigger side, above the 4-bit vertex mask. */
+
+    T aScore, bScore;
+    int aPoint, bPoint;
+
+    if (inSum <= 1) { /* Pentachoron at (0,0,0,0) */
+        aScore = xins;
+        bScore = yins;
+        aPoint = 0x01;
+        bPoint = 0x02;
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, zins, 0x04);
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, wins, 0x08);
+
+        T uins = 1 - inSum;
+        if (uins > aScore || uins > bScore)
+            return (bScore > aScore ? bPoint : aPoint) << 4;
+        return (aPoint | bPoint) << 4;
+    }
+
+    if (inSum >= 3) { /* Pentachoron at (1,1,1,1) */
+        aScore = xins;
+        bScore = yins;
+        aPoint = 0x0E;
+        bPoint = 0x0D;
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, zins, 0x0B);
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, wins, 0x07);
+
+        T uins = 4 - inSum;
+        if (uins < aScore || uins < bScore)
+            return 1 << 8 | (bScore < aScore ? bPoint : aPoint) << 4;
+        return 1 << 8 | (aPoint & bPoint) << 4;
+    }
+
+    T xy = xins + yins;
+    T zw = zins + wins;
+    T xz = xins + zins;
+    T yw = yins + wins;
+    T xw = xins + wins;
+    T yz = yins + zins;
+
+    int region;
+    if (inSum <= 2) { /* First dispentachoron */
+        region = 2;
+        aScore = xy > zw ? xy : zw;
+        aPoint = xy > zw ? 0x03 | bigger : 0x0C | bigger;
+        bScore = xz > yw ? xz : yw;
+        bPoint = xz > yw ? 0x05 | bigger : 0x0A | bigger;
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, xw > yz ? xw : yz, xw > yz ? 0x09 | bigger : 0x06 | bigger);
+
+        T remainder = 2 - inSum;
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, remainder + xins, 0x01);
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, remainder + yins, 0x02);
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, remainder + zins, 0x04);
+        RegionClassifier::closestGreater(aScore, aPoint, bScore, bPoint, remainder + wins, 0x08);
+    } else { /* Second dispentachoron */
+        region = 3;
+        aScore = xy < zw ? xy : zw;
+        aPoint = xy < zw ? 0x0C | bigger : 0x03 | bigger;
+        bScore = xz < yw ? xz : yw;
+        bPoint = xz < yw ? 0x0A | bigger : 0x05 | bigger;
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, xw < yz ? xw : yz, xw < yz ? 0x06 | bigger : 0x09 | bigger);
+
+        T remainder = 3 - inSum;
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, remainder + xins, 0x0E);
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, remainder + yins, 0x0D);
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, remainder + zins, 0x0B);
+        RegionClassifier::closestSmaller(aScore, aPoint, bScore, bPoint, remainder + wins, 0x07);
+    }
+
+    bool aBigger = (aPoint & bigger) != 0;
+    bool sameSide = (aPoint & bigger) == (bPoint & bigger);
+    aPoint &= ~bigger;
+    bPoint &= ~bigger;
+
+    int key;
+    if (!sameSide)
+        key = aBigger ? aPoint << 4 | bPoint : bPoint << 4 | aPoint;
+    else if (region == 2)
+        key = (aPoint | bPoint) << 4 | (aBigger ? aPoint & bPoint : 0);
+    else
+        key = (aPoint & bPoint) << 4 | (aBigger ? aPoint | bPoint : 0);
+    return region << 8 | key;
 }
 
-float Noise::extrapolate2(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int xsb, int ysb, float dx, float dy)
+/*
+ * Adds the contribution of one lattice vertex to value, displacing it from
+ * the point with the expression given with LatticeVertex. Vertices out of
+ * range, including the padding of short regions, are skipped rather than
+ * added as zeros, since lattices such as DerivativeLattice and
+ * MultiSeedLattice accumulate state of their own on every vertex they are
+ * asked for.
+ */
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::contribution3(const Lattice& lattice, T value, Index xsb, Index ysb, Index zsb,
+                                      T dx0, T dy0, T dz0, OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex)
 {
-    /*
-     * Gradients for 2D. They approximate the directions to the
-     * vertices of an octagon from the center.
-     */
-    const int8_t gradients2D[16] = {
-        5,  2,    2,  5,
-        -5,  2,   -2,  5,
-        5, -2,    2, -5,
-        -5, -2,   -2, -5,
-    };
-
-    int index = ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] & 0x0E;
-    return gradients2D[index] * dx
-    + gradients2D[index + 1] * dy;
+    const T squishConstant = (T) 1 / (T) 3;
+
+    T squishOffset = (vertex.x + vertex.y + vertex.z) * squishConstant;
+    T dx = dx0 - (vertex.x - vertex.lateX) - squishOffset - vertex.lateX;
+    T dy = dy0 - (vertex.y - vertex.lateY) - squishOffset - vertex.lateY;
+    T dz = dz0 - (vertex.z - vertex.lateZ) - squishOffset - vertex.lateZ;
+
+    T attn = 2 - dx * dx - dy * dy - dz * dz;
+    if (attn > 0) {
+        attn *= attn;
+        value += attn * attn * lattice.extrapolate3(xsb + vertex.x, ysb + vertex.y, zsb + vertex.z, dx, dy, dz);
+    }
+    return value;
 }
 
-float Noise::extrapolate3(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int xsb, int ysb, int zsb, float dx, float dy, float dz)
+/*
+ * The 4D counterpart of contribution3.
+ */
+template <typename T, typename Index>
+template <typename Lattice>
+T BasicNoise<T, Index>::contribution4(const Lattice& lattice, T value, Index xsb, Index ysb, Index zsb, Index wsb,
+                                      T dx0, T dy0, T dz0, T dw0, OPENSIMPLEX_GPU_CONSTANT const LatticeVertex& vertex)
 {
-    /*
-     * Gradients for 3D. They approximate the directions to the
-     * vertices of a rhombicuboctahedron from the center, skewed so
-     * that the triangular and square facets can be inscribed inside
-     * circles of the same radius.
-     */
-    const int8_t gradients3D[72] = {
-        -11,  4,  4,     -4,  11,  4,    -4,  4,  11,
-        11,  4,  4,      4,  11,  4,     4,  4,  11,
-        -11, -4,  4,     -4, -11,  4,    -4, -4,  11,
-        11, -4,  4,      4, -11,  4,     4, -4,  11,
-        -11,  4, -4,     -4,  11, -4,    -4,  4, -11,
-        11,  4, -4,      4,  11, -4,     4,  4, -11,
-        -11, -4, -4,     -4, -11, -4,    -4, -4, -11,
-        11, -4, -4,      4, -11, -4,     4, -4, -11,
-    };
-
-    int index = ctx.permGradIndex3D[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF];
-    return gradients3D[index] * dx
-    + gradients3D[index + 1] * dy
-    + gradients3D[index + 2] * dz;
+    const T squishConstant = (T) 0.309016994374947;
+
+    T squishOffset = (vertex.x + vertex.y + vertex.z + vertex.w) * squishConstant;
+    T dx = dx0 - (vertex.x - vertex.lateX) - squishOffset - vertex.lateX;
+    T dy = dy0 - (vertex.y - vertex.lateY) - squishOffset - vertex.lateY;
+    T dz = dz0 - (vertex.z - vertex.lateZ) - squishOffset - vertex.lateZ;
+    T dw = dw0 - (vertex.w - vertex.lateW) - squishOffset - vertex.lateW;
+
+    T attn = 2 - dx * dx - dy * dy - dz * dz - dw * dw;
+    if (attn > 0) {
+        attn *= attn;
+        value += attn * attn * lattice.extrapolate4(xsb + vertex.x, ysb + vertex.y, zsb + vertex.z, wsb + vertex.w, dx, dy, dz, dw);
+    }
+    return value;
 }
 
-float Noise::extrapolate4(OPENSIMPLEX_GPU_CONSTANT const Context& ctx, int xsb, int ysb, int zsb, int wsb, float dx, float dy, float dz, float dw)
+template <typename T, typename Index>
+Index BasicNoise<T, Index>::floor(T x)
 {
-    /*
-     * Gradients for 4D. They approximate the directions to the
-     * vertices of a disprismatotesseractihexadecachoron from the center,
-     * skewed so that the tetrahedral and cubic facets can be inscribed inside
-     * spheres of the same radius.
-     */
-    const int8_t gradients4D[256] = {
-        3,  1,  1,  1,      1,  3,  1,  1,      1,  1,  3,  1,      1,  1,  1,  3,
-        -3,  1,  1,  1,     -1,  3,  1,  1,     -1,  1,  3,  1,     -1,  1,  1,  3,
-        3, -1,  1,  1,      1, -3,  1,  1,      1, -1,  3,  1,      1, -1,  1,  3,
-        -3, -1,  1,  1,     -1, -3,  1,  1,     -1, -1,  3,  1,     -1, -1,  1,  3,
-        3,  1, -1,  1,      1,  3, -1,  1,      1,  1, -3,  1,      1,  1, -1,  3,
-        -3,  1, -1,  1,     -1,  3, -1,  1,     -1,  1, -3,  1,     -1,  1, -1,  3,
-        3, -1, -1,  1,      1, -3, -1,  1,      1, -1, -3,  1,      1, -1, -1,  3,
-        -3, -1, -1,  1,     -1, -3, -1,  1,     -1, -1, -3,  1,     -1, -1, -1,  3,
-        3,  1,  1, -1,      1,  3,  1, -1,      1,  1,  3, -1,      1,  1,  1, -3,
-        -3,  1,  1, -1,     -1,  3,  1, -1,     -1,  1,  3, -1,     -1,  1,  1, -3,
-        3, -1,  1, -1,      1, -3,  1, -1,      1, -1,  3, -1,      1, -1,  1, -3,
-        -3, -1,  1, -1,     -1, -3,  1, -1,     -1, -1,  3, -1,     -1, -1,  1, -3,
-        3,  1, -1, -1,      1,  3, -1, -1,      1,  1, -3, -1,      1,  1, -1, -3,
-        -3,  1, -1, -1,     -1,  3, -1, -1,     -1,  1, -3, -1,     -1,  1, -1, -3,
-        3, -1, -1, -1,      1, -3, -1, -1,      1, -1, -3, -1,      1, -1, -1, -3,
-        -3, -1, -1, -1,     -1, -3, -1, -1,     -1, -1, -3, -1,     -1, -1, -1, -3,
-    };
-
-    int index = ctx.perm[(ctx.perm[(ctx.perm[(ctx.perm[xsb & 0xFF] + ysb) & 0xFF] + zsb) & 0xFF] + wsb) & 0xFF] & 0xFC;
-    return gradients4D[index] * dx
-    + gradients4D[index + 1] * dy
-    + gradients4D[index + 2] * dz
-    + gradients4D[index + 3] * dw;
+    Index xi = (Index) x;
+    return x < xi ? xi - 1 : xi;
 }
 
 }
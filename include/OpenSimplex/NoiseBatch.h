@@ -0,0 +1,1667 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "NoiseBatch is a CPU SIMD API - on the GPU, evaluate Noise per thread instead!"
+#endif
+
+#include <cstddef>
+
+#include "Context.h"
+#include "Dispatch.h"
+#include "Gradients.h"
+#include "Noise.h"
+#include "VertexTables.h"
+
+#if OPENSIMPLEX_IS_X86
+    #include <immintrin.h>
+#endif
+
+/*
+ * GCC does not apply the fp-contract pragma around the AVX-512 code below to
+ * templates instantiated after it, so the AVX-512 kernel templates ask for it
+ * themselves.
+ */
+#if OPENSIMPLEX_IS_X86 && defined(__GNUC__) && !defined(__clang__)
+    #define OPENSIMPLEX_NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+    #define OPENSIMPLEX_NO_FP_CONTRACT
+#endif
+
+namespace OpenSimplex
+{
+
+/*
+ * Evaluates noise over arrays of points, several points per SIMD register.
+ * Region selection is done with masked blends rather than branches and the
+ * permutation lookups use vector gathers where the instruction set has them.
+ * In 3D and 4D the lattice vertices each point visits are looked up in
+ * VertexTables, so every lane walks the same sequence of steps. Through a
+ * HashContext the gradients are hashed arithmetically instead, with no
+ * gathers other than the 4D gradient fetch under AVX2.
+ *
+ * Where the compiler allows it, every kernel is built in and the best one for
+ * the running CPU is chosen once, on the first call (see Dispatch.h).
+ * Otherwise the kernel is picked at compile time from the targeted
+ * instruction sets.
+ *
+ * The kernels perform exactly the same IEEE operations in the same order as
+ * the scalar Noise functions, so results are bit-identical (0 ULP) to them
+ * as long as neither side is compiled with value-changing floating point
+ * optimizations (-ffast-math, /fp:fast or FMA contraction).
+ */
+class NoiseBatch
+{
+public:
+    inline static void noise2Batch(const Context& context, const float* xs, const float* ys, float* out, size_t count);
+    inline static void noise3Batch(const Context& context, const float* xs, const float* ys, const float* zs, float* out, size_t count);
+    inline static void noise4Batch(const Context& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count);
+
+    inline static void noise2Batch(const HashContext& context, const float* xs, const float* ys, float* out, size_t count);
+    inline static void noise3Batch(const HashContext& context, const float* xs, const float* ys, const float* zs, float* out, size_t count);
+    inline static void noise4Batch(const HashContext& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count);
+
+#if OPENSIMPLEX_HAS_DISPATCH
+    /*
+     * The kernels the batch calls are routed to. kernelsFor is public so
+     * that each set can be checked against the scalar functions; only call
+     * through sets up to Dispatch::instructionSet().
+     */
+    struct Kernels
+    {
+        void (*noise2)(const Context&, const float*, const float*, float*, size_t);
+        void (*noise3)(const Context&, const float*, const float*, const float*, float*, size_t);
+        void (*noise4)(const Context&, const float*, const float*, const float*, const float*, float*, size_t);
+        void (*noise2Hash)(const HashContext&, const float*, const float*, float*, size_t);
+        void (*noise3Hash)(const HashContext&, const float*, const float*, const float*, float*, size_t);
+        void (*noise4Hash)(const HashContext&, const float*, const float*, const float*, const float*, float*, size_t);
+    };
+
+    inline static Kernels kernelsFor(Dispatch::InstructionSet instructionSet);
+#endif
+
+private:
+#if OPENSIMPLEX_HAS_DISPATCH
+    inline static const Kernels& kernels();
+#endif
+
+    template <typename ContextType> inline static void noise2Scalar(const ContextType& context, const float* xs, const float* ys, float* out, size_t count);
+    template <typename ContextType> inline static void noise3Scalar(const ContextType& context, const float* xs, const float* ys, const float* zs, float* out, size_t count);
+    template <typename ContextType> inline static void noise4Scalar(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count);
+
+#if OPENSIMPLEX_IS_X86
+    OPENSIMPLEX_TARGET("sse4.1") inline static void noise2SSE41(const Context& context, const float* xs, const float* ys, float* out, size_t count);
+    OPENSIMPLEX_TARGET("sse4.1") inline static __m128i floorSSE41(__m128 x);
+    OPENSIMPLEX_TARGET("sse4.1") inline static __m128 contribution2SSE41(const Context& context, __m128 value, __m128i xsb, __m128i ysb, __m128 dx0, __m128 dy0, __m128i xsv, __m128i ysv);
+
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static void noise2AVX2(const ContextType& context, const float* xs, const float* ys, float* out, size_t count);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i floorAVX2(__m256 x);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i permAVX2(const Context& context, __m256i index);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i hashAVX2(const HashContext& context, __m256i x, __m256i y, __m256i z, __m256i w);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient2AVX2(const Context& context, __m256i x, __m256i y);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient2AVX2(const HashContext& context, __m256i x, __m256i y);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static __m256 contribution2AVX2(const ContextType& context, __m256 value, __m256i xsb, __m256i ysb, __m256 dx0, __m256 dy0, __m256i xsv, __m256i ysv);
+
+    inline static int32_t packOffsets(const LatticeVertex& vertex);
+    inline static int32_t packLateOffsets(const LatticeVertex& vertex);
+    inline static void packGradients3D(const Context& context, int32_t* words);
+    inline static void packGradients3D(const HashContext& context, int32_t* words);
+
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static void noise3AVX2(const ContextType& context, const float* xs, const float* ys, const float* zs, float* out, size_t count);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static void noise4AVX2(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient3AVX2(const Context& context, const int32_t* gradients, __m256i x, __m256i y, __m256i z);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient3AVX2(const HashContext& context, const int32_t* gradients, __m256i x, __m256i y, __m256i z);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient4AVX2(const Context& context, __m256i x, __m256i y, __m256i z, __m256i w);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i gradient4AVX2(const HashContext& context, __m256i x, __m256i y, __m256i z, __m256i w);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i unpackAVX2(__m256i packed, int axis);
+    OPENSIMPLEX_TARGET("avx2") inline static void closestGreaterAVX2(__m256& aScore, __m256i& aPoint, __m256& bScore, __m256i& bPoint, __m256 score, __m256i point);
+    OPENSIMPLEX_TARGET("avx2") inline static void closestSmallerAVX2(__m256& aScore, __m256i& aPoint, __m256& bScore, __m256i& bPoint, __m256 score, __m256i point);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i classify3AVX2(__m256 xins, __m256 yins, __m256 zins, __m256 inSum);
+    OPENSIMPLEX_TARGET("avx2") inline static __m256i classify4AVX2(__m256 xins, __m256 yins, __m256 zins, __m256 wins, __m256 inSum);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static __m256 contribution3AVX2(const ContextType& context, const int32_t* gradients, __m256 value, __m256i xsb, __m256i ysb, __m256i zsb, __m256 dx0, __m256 dy0, __m256 dz0, __m256i offsets, __m256i lateOffsets);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx2") inline static __m256 contribution4AVX2(const ContextType& context, __m256 value, __m256i xsb, __m256i ysb, __m256i zsb, __m256i wsb, __m256 dx0, __m256 dy0, __m256 dz0, __m256 dw0, __m256i offsets, __m256i lateOffsets);
+
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx512f") OPENSIMPLEX_NO_FP_CONTRACT inline static void noise3AVX512(const ContextType& context, const float* xs, const float* ys, const float* zs, float* out, size_t count);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx512f") OPENSIMPLEX_NO_FP_CONTRACT inline static void noise4AVX512(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i floorAVX512(__m512 x);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i permAVX512(const Context& context, __m512i index);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i hashAVX512(const HashContext& context, __m512i x, __m512i y, __m512i z, __m512i w);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i gradient3AVX512(const Context& context, const int32_t* gradients, __m512i x, __m512i y, __m512i z);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i gradient3AVX512(const HashContext& context, const int32_t* gradients, __m512i x, __m512i y, __m512i z);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i gradient4AVX512(const Context& context, __m512i x, __m512i y, __m512i z, __m512i w);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i gradient4AVX512(const HashContext& context, __m512i x, __m512i y, __m512i z, __m512i w);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i unpackAVX512(__m512i packed, int axis);
+    OPENSIMPLEX_TARGET("avx512f") inline static void closestGreaterAVX512(__m512& aScore, __m512i& aPoint, __m512& bScore, __m512i& bPoint, __m512 score, __m512i point);
+    OPENSIMPLEX_TARGET("avx512f") inline static void closestSmallerAVX512(__m512& aScore, __m512i& aPoint, __m512& bScore, __m512i& bPoint, __m512 score, __m512i point);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i classify3AVX512(__m512 xins, __m512 yins, __m512 zins, __m512 inSum);
+    OPENSIMPLEX_TARGET("avx512f") inline static __m512i classify4AVX512(__m512 xins, __m512 yins, __m512 zins, __m512 wins, __m512 inSum);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx512f") OPENSIMPLEX_NO_FP_CONTRACT inline static __m512 contribution3AVX512(const ContextType& context, const int32_t* gradients, __m512 value, __m512i xsb, __m512i ysb, __m512i zsb, __m512 dx0, __m512 dy0, __m512 dz0, __m512i offsets, __m512i lateOffsets);
+    template <typename ContextType> OPENSIMPLEX_TARGET("avx512f") OPENSIMPLEX_NO_FP_CONTRACT inline static __m512 contribution4AVX512(const ContextType& context, __m512 value, __m512i xsb, __m512i ysb, __m512i zsb, __m512i wsb, __m512 dx0, __m512 dy0, __m512 dz0, __m512 dw0, __m512i offsets, __m512i lateOffsets);
+#endif
+};
+
+/*
+ * 2D noise for count points. Matches Noise::noise2 point for point.
+ */
+void NoiseBatch::noise2Batch(const Context& context, const float* xs, const float* ys, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise2(context, xs, ys, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise2AVX2(context, xs, ys, out, count);
+#elif OPENSIMPLEX_IS_X86 && (defined(__SSE4_1__) || defined(__AVX__))
+    noise2SSE41(context, xs, ys, out, count);
+#else
+    noise2Scalar(context, xs, ys, out, count);
+#endif
+}
+
+/*
+ * 3D noise for count points. Matches Noise::noise3 point for point.
+ */
+void NoiseBatch::noise3Batch(const Context& context, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise3(context, xs, ys, zs, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX512F__)
+    noise3AVX512(context, xs, ys, zs, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise3AVX2(context, xs, ys, zs, out, count);
+#else
+    noise3Scalar(context, xs, ys, zs, out, count);
+#endif
+}
+
+/*
+ * 4D noise for count points. Matches Noise::noise4 point for point.
+ */
+void NoiseBatch::noise4Batch(const Context& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise4(context, xs, ys, zs, ws, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX512F__)
+    noise4AVX512(context, xs, ys, zs, ws, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise4AVX2(context, xs, ys, zs, ws, out, count);
+#else
+    noise4Scalar(context, xs, ys, zs, ws, out, count);
+#endif
+}
+
+/*
+ * 2D noise for count points through a HashContext. Matches
+ * Noise::noise2(HashContext, ...) point for point.
+ */
+void NoiseBatch::noise2Batch(const HashContext& context, const float* xs, const float* ys, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise2Hash(context, xs, ys, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise2AVX2(context, xs, ys, out, count);
+#else
+    noise2Scalar(context, xs, ys, out, count);
+#endif
+}
+
+/*
+ * 3D noise for count points through a HashContext. Matches
+ * Noise::noise3(HashContext, ...) point for point.
+ */
+void NoiseBatch::noise3Batch(const HashContext& context, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise3Hash(context, xs, ys, zs, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX512F__)
+    noise3AVX512(context, xs, ys, zs, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise3AVX2(context, xs, ys, zs, out, count);
+#else
+    noise3Scalar(context, xs, ys, zs, out, count);
+#endif
+}
+
+/*
+ * 4D noise for count points through a HashContext. Matches
+ * Noise::noise4(HashContext, ...) point for point.
+ */
+void NoiseBatch::noise4Batch(const HashContext& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count)
+{
+#if OPENSIMPLEX_HAS_DISPATCH
+    kernels().noise4Hash(context, xs, ys, zs, ws, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX512F__)
+    noise4AVX512(context, xs, ys, zs, ws, out, count);
+#elif OPENSIMPLEX_IS_X86 && defined(__AVX2__)
+    noise4AVX2(context, xs, ys, zs, ws, out, count);
+#else
+    noise4Scalar(context, xs, ys, zs, ws, out, count);
+#endif
+}
+
+#if OPENSIMPLEX_HAS_DISPATCH
+
+const NoiseBatch::Kernels& NoiseBatch::kernels()
+{
+    static const Kernels resolved = kernelsFor(Dispatch::instructionSet());
+    return resolved;
+}
+
+/*
+ * The fastest kernel for each dimension that instructionSet can run. SSE2
+ * alone has no kernel of its own, as the scalar code already uses it.
+ */
+NoiseBatch::Kernels NoiseBatch::kernelsFor(Dispatch::InstructionSet instructionSet)
+{
+    Kernels result = { noise2Scalar<Context>, noise3Scalar<Context>, noise4Scalar<Context>,
+                       noise2Scalar<HashContext>, noise3Scalar<HashContext>, noise4Scalar<HashContext> };
+    switch (instructionSet) {
+        case Dispatch::InstructionSet::AVX512:
+            result.noise2 = noise2AVX2<Context>;
+            result.noise3 = noise3AVX512<Context>;
+            result.noise4 = noise4AVX512<Context>;
+            result.noise2Hash = noise2AVX2<HashContext>;
+            result.noise3Hash = noise3AVX512<HashContext>;
+            result.noise4Hash = noise4AVX512<HashContext>;
+            break;
+        case Dispatch::InstructionSet::AVX2:
+            result.noise2 = noise2AVX2<Context>;
+            result.noise3 = noise3AVX2<Context>;
+            result.noise4 = noise4AVX2<Context>;
+            result.noise2Hash = noise2AVX2<HashContext>;
+            result.noise3Hash = noise3AVX2<HashContext>;
+            result.noise4Hash = noise4AVX2<HashContext>;
+            break;
+        case Dispatch::InstructionSet::SSE41:
+            result.noise2 = noise2SSE41;
+            break;
+        case Dispatch::InstructionSet::SSE2:
+        case Dispatch::InstructionSet::Scalar:
+            break;
+    }
+    return result;
+}
+
+#endif
+
+template <typename ContextType>
+void NoiseBatch::noise2Scalar(const ContextType& context, const float* xs, const float* ys, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = Noise::noise2(context, xs[i], ys[i]);
+}
+
+template <typename ContextType>
+void NoiseBatch::noise3Scalar(const ContextType& context, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = Noise::noise3(context, xs[i], ys[i], zs[i]);
+}
+
+template <typename ContextType>
+void NoiseBatch::noise4Scalar(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        out[i] = Noise::noise4(context, xs[i], ys[i], zs[i], ws[i]);
+}
+
+#if OPENSIMPLEX_IS_X86
+
+/*
+ * The vector kernels below mirror Noise::noise2, with the per-point choice
+ * of the base and extra vertices expressed as lattice offsets (a, b) from
+ * the super-cell origin. Each vertex is then displaced from the origin as
+ * (dx0 - a) - (a + b) * squishConstant, which is the exact expression the
+ * scalar code uses for every vertex it visits.
+ */
+
+__m128i NoiseBatch::floorSSE41(__m128 x)
+{
+    __m128i xi = _mm_cvttps_epi32(x);
+    return _mm_add_epi32(xi, _mm_castps_si128(_mm_cmplt_ps(x, _mm_cvtepi32_ps(xi))));
+}
+
+__m128 NoiseBatch::contribution2SSE41(const Context& ctx, __m128 value, __m128i xsb, __m128i ysb, __m128 dx0, __m128 dy0, __m128i xsv, __m128i ysv)
+{
+    const __m128 squishConstant = _mm_set1_ps(0.366025403784439f);
+
+    __m128 squishOffset = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(xsv, ysv)), squishConstant);
+    __m128 dx = _mm_sub_ps(_mm_sub_ps(dx0, _mm_cvtepi32_ps(xsv)), squishOffset);
+    __m128 dy = _mm_sub_ps(_mm_sub_ps(dy0, _mm_cvtepi32_ps(ysv)), squishOffset);
+    __m128 attn = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(dx, dx)), _mm_mul_ps(dy, dy));
+    __m128 mask = _mm_cmpgt_ps(attn, _mm_setzero_ps());
+    if (_mm_movemask_ps(mask) == 0)
+        return value;
+
+    /* SSE has no gathers, so hash the four lattice vertices one lane at a time. */
+    alignas(16) int32_t xv[4], yv[4];
+    alignas(16) float gx[4], gy[4];
+    _mm_store_si128((__m128i*) xv, _mm_add_epi32(xsb, xsv));
+    _mm_store_si128((__m128i*) yv, _mm_add_epi32(ysb, ysv));
+    for (int lane = 0; lane < 4; lane++) {
+        int index = ctx.perm[(ctx.perm[xv[lane] & 0xFF] + yv[lane]) & 0xFF] & 0x0E;
+        gx[lane] = gradients2D[index];
+        gy[lane] = gradients2D[index + 1];
+    }
+
+    __m128 extrapolation = _mm_add_ps(_mm_mul_ps(_mm_load_ps(gx), dx), _mm_mul_ps(_mm_load_ps(gy), dy));
+    attn = _mm_mul_ps(attn, attn);
+    return _mm_add_ps(value, _mm_and_ps(mask, _mm_mul_ps(_mm_mul_ps(attn, attn), extrapolation)));
+}
+
+void NoiseBatch::noise2SSE41(const Context& ctx, const float* xs, const float* ys, float* out, size_t count)
+{
+    const __m128 stretchConstant = _mm_set1_ps(-0.211324865405187f);
+    const __m128 squishConstant = _mm_set1_ps(0.366025403784439f);
+    const __m128 normConstant = _mm_set1_ps(47.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128i zeroi = _mm_setzero_si128();
+    const __m128i onei = _mm_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+
+        /* Place input coordinates onto grid. */
+        __m128 stretchOffset = _mm_mul_ps(_mm_add_ps(x, y), stretchConstant);
+        __m128 xs4 = _mm_add_ps(x, stretchOffset);
+        __m128 ys4 = _mm_add_ps(y, stretchOffset);
+
+        /* Floor to get grid coordinates of rhombus (stretched square) super-cell origin. */
+        __m128i xsb = floorSSE41(xs4);
+        __m128i ysb = floorSSE41(ys4);
+        __m128 xsbf = _mm_cvtepi32_ps(xsb);
+        __m128 ysbf = _mm_cvtepi32_ps(ysb);
+
+        /* Skew out to get actual coordinates of rhombus origin. */
+        __m128 squishOffset = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(xsb, ysb)), squishConstant);
+        __m128 dx0 = _mm_sub_ps(x, _mm_add_ps(xsbf, squishOffset));
+        __m128 dy0 = _mm_sub_ps(y, _mm_add_ps(ysbf, squishOffset));
+
+        /* Compute grid coordinates relative to rhombus origin and the region selector. */
+        __m128 xins = _mm_sub_ps(xs4, xsbf);
+        __m128 yins = _mm_sub_ps(ys4, ysbf);
+        __m128 inSum = _mm_add_ps(xins, yins);
+
+        __m128 value = _mm_setzero_ps();
+        value = contribution2SSE41(ctx, value, xsb, ysb, dx0, dy0, onei, zeroi);
+        value = contribution2SSE41(ctx, value, xsb, ysb, dx0, dy0, zeroi, onei);
+
+        /* Lanes past inSum = 1 are in the triangle at (1,1) rather than (0,0). */
+        __m128i upper = _mm_castps_si128(_mm_cmpgt_ps(inSum, one));
+        __m128i xGreater = _mm_castps_si128(_mm_cmpgt_ps(xins, yins));
+        __m128 zinsLower = _mm_sub_ps(one, inSum);
+        __m128 zinsUpper = _mm_sub_ps(two, inSum);
+        __m128i nearLower = _mm_castps_si128(_mm_or_ps(_mm_cmpgt_ps(zinsLower, xins), _mm_cmpgt_ps(zinsLower, yins)));
+        __m128i nearUpper = _mm_castps_si128(_mm_or_ps(_mm_cmplt_ps(zinsUpper, xins), _mm_cmplt_ps(zinsUpper, yins)));
+
+        /* Extra vertex in the lower triangle: (1,-1) or (-1,1), otherwise (1,1). */
+        __m128i xsvLower = _mm_blendv_epi8(onei, _mm_blendv_epi8(_mm_set1_epi32(-1), onei, xGreater), nearLower);
+        __m128i ysvLower = _mm_blendv_epi8(onei, _mm_blendv_epi8(onei, _mm_set1_epi32(-1), xGreater), nearLower);
+
+        /* Extra vertex in the upper triangle: (2,0) or (0,2), otherwise (0,0). */
+        __m128i xsvUpper = _mm_blendv_epi8(zeroi, _mm_blendv_epi8(zeroi, _mm_set1_epi32(2), xGreater), nearUpper);
+        __m128i ysvUpper = _mm_blendv_epi8(zeroi, _mm_blendv_epi8(_mm_set1_epi32(2), zeroi, xGreater), nearUpper);
+
+        /* Contribution (0,0) or (1,1) */
+        __m128i base = _mm_and_si128(upper, onei);
+        value = contribution2SSE41(ctx, value, xsb, ysb, dx0, dy0, base, base);
+
+        /* Extra Vertex */
+        value = contribution2SSE41(ctx, value, xsb, ysb, dx0, dy0,
+                                   _mm_blendv_epi8(xsvLower, xsvUpper, upper), _mm_blendv_epi8(ysvLower, ysvUpper, upper));
+
+        _mm_storeu_ps(out + i, _mm_div_ps(value, normConstant));
+    }
+
+    noise2Scalar(ctx, xs + i, ys + i, out + i, count - i);
+}
+
+__m256i NoiseBatch::floorAVX2(__m256 x)
+{
+    __m256i xi = _mm256_cvttps_epi32(x);
+    return _mm256_add_epi32(xi, _mm256_castps_si256(_mm256_cmp_ps(x, _mm256_cvtepi32_ps(xi), _CMP_LT_OQ)));
+}
+
+/*
+ * Gathers perm[index & 0xFF] for eight lanes. The 32-bit gather reads the
+ * neighbouring int16_t as well, which for perm[255] is still inside Context.
+ */
+__m256i NoiseBatch::permAVX2(const Context& ctx, __m256i index)
+{
+    __m256i words = _mm256_i32gather_epi32((const int*) ctx.perm, _mm256_and_si256(index, _mm256_set1_epi32(0xFF)), 2);
+    return _mm256_and_si256(words, _mm256_set1_epi32(0xFFFF));
+}
+
+/*
+ * HashLattice::hash for eight lanes. Axes a caller has no use for are
+ * passed as zero and drop out of the sum.
+ */
+__m256i NoiseBatch::hashAVX2(const HashContext& ctx, __m256i x, __m256i y, __m256i z, __m256i w)
+{
+    __m256i h = _mm256_add_epi32(_mm256_set1_epi32((int32_t) ctx.seed), _mm256_mullo_epi32(x, _mm256_set1_epi32((int32_t) 0x8DA6B343u)));
+    h = _mm256_add_epi32(h, _mm256_mullo_epi32(y, _mm256_set1_epi32((int32_t) 0xD8163841u)));
+    h = _mm256_add_epi32(h, _mm256_mullo_epi32(z, _mm256_set1_epi32((int32_t) 0xCB1AB31Fu)));
+    h = _mm256_add_epi32(h, _mm256_mullo_epi32(w, _mm256_set1_epi32((int32_t) 0x165667B1u)));
+    h = _mm256_mullo_epi32(_mm256_xor_si256(h, _mm256_srli_epi32(h, 16)), _mm256_set1_epi32((int32_t) 0x85EBCA6Bu));
+    return _mm256_mullo_epi32(_mm256_xor_si256(h, _mm256_srli_epi32(h, 13)), _mm256_set1_epi32((int32_t) 0xC2B2AE35u));
+}
+
+/*
+ * The number (0 to 7) of the 2D gradient at lattice vertex (x, y).
+ */
+__m256i NoiseBatch::gradient2AVX2(const Context& ctx, __m256i x, __m256i y)
+{
+    __m256i hash = permAVX2(ctx, _mm256_add_epi32(permAVX2(ctx, x), y));
+    return _mm256_srli_epi32(_mm256_and_si256(hash, _mm256_set1_epi32(0x0E)), 1);
+}
+
+__m256i NoiseBatch::gradient2AVX2(const HashContext& ctx, __m256i x, __m256i y)
+{
+    return _mm256_srli_epi32(hashAVX2(ctx, x, y, _mm256_setzero_si256(), _mm256_setzero_si256()), 29);
+}
+
+template <typename ContextType>
+__m256 NoiseBatch::contribution2AVX2(const ContextType& ctx, __m256 value, __m256i xsb, __m256i ysb, __m256 dx0, __m256 dy0, __m256i xsv, __m256i ysv)
+{
+    const __m256 squishConstant = _mm256_set1_ps(0.366025403784439f);
+
+    /* The eight 2D gradients fit in a register, so they are permuted rather than gathered. */
+    const __m256 gradientsX = _mm256_setr_ps(gradients2D[0], gradients2D[2], gradients2D[4], gradients2D[6],
+                                             gradients2D[8], gradients2D[10], gradients2D[12], gradients2D[14]);
+    const __m256 gradientsY = _mm256_setr_ps(gradients2D[1], gradients2D[3], gradients2D[5], gradients2D[7],
+                                             gradients2D[9], gradients2D[11], gradients2D[13], gradients2D[15]);
+
+    __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(xsv, ysv)), squishConstant);
+    __m256 dx = _mm256_sub_ps(_mm256_sub_ps(dx0, _mm256_cvtepi32_ps(xsv)), squishOffset);
+    __m256 dy = _mm256_sub_ps(_mm256_sub_ps(dy0, _mm256_cvtepi32_ps(ysv)), squishOffset);
+    __m256 attn = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(dx, dx)), _mm256_mul_ps(dy, dy));
+    __m256 mask = _mm256_cmp_ps(attn, _mm256_setzero_ps(), _CMP_GT_OQ);
+    if (_mm256_movemask_ps(mask) == 0)
+        return value;
+
+    __m256i gradient = gradient2AVX2(ctx, _mm256_add_epi32(xsb, xsv), _mm256_add_epi32(ysb, ysv));
+
+    __m256 extrapolation = _mm256_add_ps(_mm256_mul_ps(_mm256_permutevar8x32_ps(gradientsX, gradient), dx),
+                                         _mm256_mul_ps(_mm256_permutevar8x32_ps(gradientsY, gradient), dy));
+    attn = _mm256_mul_ps(attn, attn);
+    return _mm256_add_ps(value, _mm256_and_ps(mask, _mm256_mul_ps(_mm256_mul_ps(attn, attn), extrapolation)));
+}
+
+template <typename ContextType>
+void NoiseBatch::noise2AVX2(const ContextType& ctx, const float* xs, const float* ys, float* out, size_t count)
+{
+    const __m256 stretchConstant = _mm256_set1_ps(-0.211324865405187f);
+    const __m256 squishConstant = _mm256_set1_ps(0.366025403784439f);
+    const __m256 normConstant = _mm256_set1_ps(47.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256i zeroi = _mm256_setzero_si256();
+    const __m256i onei = _mm256_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+
+        /* Place input coordinates onto grid. */
+        __m256 stretchOffset = _mm256_mul_ps(_mm256_add_ps(x, y), stretchConstant);
+        __m256 xs8 = _mm256_add_ps(x, stretchOffset);
+        __m256 ys8 = _mm256_add_ps(y, stretchOffset);
+
+        /* Floor to get grid coordinates of rhombus (stretched square) super-cell origin. */
+        __m256i xsb = floorAVX2(xs8);
+        __m256i ysb = floorAVX2(ys8);
+        __m256 xsbf = _mm256_cvtepi32_ps(xsb);
+        __m256 ysbf = _mm256_cvtepi32_ps(ysb);
+
+        /* Skew out to get actual coordinates of rhombus origin. */
+        __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(xsb, ysb)), squishConstant);
+        __m256 dx0 = _mm256_sub_ps(x, _mm256_add_ps(xsbf, squishOffset));
+        __m256 dy0 = _mm256_sub_ps(y, _mm256_add_ps(ysbf, squishOffset));
+
+        /* Compute grid coordinates relative to rhombus origin and the region selector. */
+        __m256 xins = _mm256_sub_ps(xs8, xsbf);
+        __m256 yins = _mm256_sub_ps(ys8, ysbf);
+        __m256 inSum = _mm256_add_ps(xins, yins);
+
+        __m256 value = _mm256_setzero_ps();
+        value = contribution2AVX2(ctx, value, xsb, ysb, dx0, dy0, onei, zeroi);
+        value = contribution2AVX2(ctx, value, xsb, ysb, dx0, dy0, zeroi, onei);
+
+        /* Lanes past inSum = 1 are in the triangle at (1,1) rather than (0,0). */
+        __m256i upper = _mm256_castps_si256(_mm256_cmp_ps(inSum, one, _CMP_GT_OQ));
+        __m256i xGreater = _mm256_castps_si256(_mm256_cmp_ps(xins, yins, _CMP_GT_OQ));
+        __m256 zinsLower = _mm256_sub_ps(one, inSum);
+        __m256 zinsUpper = _mm256_sub_ps(two, inSum);
+        __m256i nearLower = _mm256_castps_si256(_mm256_or_ps(_mm256_cmp_ps(zinsLower, xins, _CMP_GT_OQ),
+                                                             _mm256_cmp_ps(zinsLower, yins, _CMP_GT_OQ)));
+        __m256i nearUpper = _mm256_castps_si256(_mm256_or_ps(_mm256_cmp_ps(zinsUpper, xins, _CMP_LT_OQ),
+                                                             _mm256_cmp_ps(zinsUpper, yins, _CMP_LT_OQ)));
+
+        /* Extra vertex in the lower triangle: (1,-1) or (-1,1), otherwise (1,1). */
+        __m256i xsvLower = _mm256_blendv_epi8(onei, _mm256_blendv_epi8(_mm256_set1_epi32(-1), onei, xGreater), nearLower);
+        __m256i ysvLower = _mm256_blendv_epi8(onei, _mm256_blendv_epi8(onei, _mm256_set1_epi32(-1), xGreater), nearLower);
+
+        /* Extra vertex in the upper triangle: (2,0) or (0,2), otherwise (0,0). */
+        __m256i xsvUpper = _mm256_blendv_epi8(zeroi, _mm256_blendv_epi8(zeroi, _mm256_set1_epi32(2), xGreater), nearUpper);
+        __m256i ysvUpper = _mm256_blendv_epi8(zeroi, _mm256_blendv_epi8(_mm256_set1_epi32(2), zeroi, xGreater), nearUpper);
+
+        /* Contribution (0,0) or (1,1) */
+        __m256i base = _mm256_and_si256(upper, onei);
+        value = contribution2AVX2(ctx, value, xsb, ysb, dx0, dy0, base, base);
+
+        /* Extra Vertex */
+        value = contribution2AVX2(ctx, value, xsb, ysb, dx0, dy0,
+                                  _mm256_blendv_epi8(xsvLower, xsvUpper, upper), _mm256_blendv_epi8(ysvLower, ysvUpper, upper));
+
+        _mm256_storeu_ps(out + i, _mm256_div_ps(value, normConstant));
+    }
+
+    noise2Scalar(ctx, xs + i, ys + i, out + i, count - i);
+}
+
+/*
+ * The 3D and 4D kernels evaluate the vertices from VertexTables. A vertex
+ * travels through the kernels as its offsets packed one byte per axis into
+ * a 32-bit lane, with a second lane of the same shape for its late part.
+ */
+
+int32_t NoiseBatch::packOffsets(const LatticeVertex& vertex)
+{
+    return (int32_t) ((uint32_t) (uint8_t) vertex.x | (uint32_t) (uint8_t) vertex.y << 8
+                      | (uint32_t) (uint8_t) vertex.z << 16 | (uint32_t) (uint8_t) vertex.w << 24);
+}
+
+int32_t NoiseBatch::packLateOffsets(const LatticeVertex& vertex)
+{
+    return (int32_t) ((uint32_t) (uint8_t) vertex.lateX | (uint32_t) (uint8_t) vertex.lateY << 8
+                      | (uint32_t) (uint8_t) vertex.lateZ << 16 | (uint32_t) (uint8_t) vertex.lateW << 24);
+}
+
+/*
+ * Resolves permGradIndex3D into the gradients themselves, with the three
+ * components packed into one 32-bit word per entry. The kernels build this
+ * once per call so that a single gather fetches a whole gradient.
+ */
+void NoiseBatch::packGradients3D(const Context& ctx, int32_t* words)
+{
+    for (int i = 0; i < 256; i++) {
+        int index = ctx.permGradIndex3D[i];
+        words[i] = (int32_t) ((uint32_t) (uint8_t) gradients3D[index] | (uint32_t) (uint8_t) gradients3D[index + 1] << 8
+                              | (uint32_t) (uint8_t) gradients3D[index + 2] << 16);
+    }
+}
+
+/*
+ * The HashContext kernels index the 24 3D gradients directly, so only the
+ * first 32 words (two AVX-512 registers) are filled in, the last 8 repeating
+ * the first.
+ */
+void NoiseBatch::packGradients3D(const HashContext&, int32_t* words)
+{
+    for (int i = 0; i < 32; i++) {
+        int index = (i % 24) * 3;
+        words[i] = (int32_t) ((uint32_t) (uint8_t) gradients3D[index] | (uint32_t) (uint8_t) gradients3D[index + 1] << 8
+                              | (uint32_t) (uint8_t) gradients3D[index + 2] << 16);
+    }
+}
+
+/*
+ * Sign-extends byte axis (0 to 3) of each lane.
+ */
+__m256i NoiseBatch::unpackAVX2(__m256i packed, int axis)
+{
+    return _mm256_srai_epi32(_mm256_sll_epi32(packed, _mm_cvtsi32_si128(24 - 8 * axis)), 24);
+}
+
+/*
+ * Offers point with score to the closest pair (a, b), replacing the one the
+ * scalar code would when looking for the highest scores.
+ */
+void NoiseBatch::closestGreaterAVX2(__m256& aScore, __m256i& aPoint, __m256& bScore, __m256i& bPoint, __m256 score, __m256i point)
+{
+    __m256 replaceB = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_GE_OQ), _mm256_cmp_ps(score, bScore, _CMP_GT_OQ));
+    __m256 replaceA = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_LT_OQ), _mm256_cmp_ps(score, aScore, _CMP_GT_OQ));
+    bScore = _mm256_blendv_ps(bScore, score, replaceB);
+    bPoint = _mm256_blendv_epi8(bPoint, point, _mm256_castps_si256(replaceB));
+    aScore = _mm256_blendv_ps(aScore, score, replaceA);
+    aPoint = _mm256_blendv_epi8(aPoint, point, _mm256_castps_si256(replaceA));
+}
+
+/*
+ * As closestGreaterAVX2, but looking for the lowest scores.
+ */
+void NoiseBatch::closestSmallerAVX2(__m256& aScore, __m256i& aPoint, __m256& bScore, __m256i& bPoint, __m256 score, __m256i point)
+{
+    __m256 replaceB = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_LE_OQ), _mm256_cmp_ps(score, bScore, _CMP_LT_OQ));
+    __m256 replaceA = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_GT_OQ), _mm256_cmp_ps(score, aScore, _CMP_LT_OQ));
+    bScore = _mm256_blendv_ps(bScore, score, replaceB);
+    bPoint = _mm256_blendv_epi8(bPoint, point, _mm256_castps_si256(replaceB));
+    aScore = _mm256_blendv_ps(aScore, score, replaceA);
+    aPoint = _mm256_blendv_epi8(aPoint, point, _mm256_castps_si256(replaceA));
+}
+
+/*
+ * Runs the closest-vertex selection of Noise::noise3 for every region and
+ * returns the extraVertexIndex3D key of the region each lane is in.
+ */
+__m256i NoiseBatch::classify3AVX2(__m256 xins, __m256 yins, __m256 zins, __m256 inSum)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i further = _mm256_set1_epi32(0x08); /* Marks a point on the further side, above the 3-bit vertex mask. */
+
+    /* Tetrahedron at (0,0,0): which two of (0,0,1), (0,1,0), (1,0,0) are closest. */
+    __m256 aScore = xins;
+    __m256 bScore = yins;
+    __m256i aPoint = _mm256_set1_epi32(0x01);
+    __m256i bPoint = _mm256_set1_epi32(0x02);
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, zins, _mm256_set1_epi32(0x04));
+
+    __m256 wins = _mm256_sub_ps(one, inSum);
+    __m256 near = _mm256_or_ps(_mm256_cmp_ps(wins, aScore, _CMP_GT_OQ), _mm256_cmp_ps(wins, bScore, _CMP_GT_OQ));
+    __m256i closest = _mm256_blendv_epi8(aPoint, bPoint, _mm256_castps_si256(_mm256_cmp_ps(bScore, aScore, _CMP_GT_OQ)));
+    __m256i c = _mm256_blendv_epi8(_mm256_or_si256(aPoint, bPoint), closest, _mm256_castps_si256(near));
+    __m256i keyLower = _mm256_slli_epi32(c, 3);
+
+    /* Tetrahedron at (1,1,1): which two of (1,1,0), (1,0,1), (0,1,1) are closest. */
+    aScore = xins;
+    bScore = yins;
+    aPoint = _mm256_set1_epi32(0x06);
+    bPoint = _mm256_set1_epi32(0x05);
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, zins, _mm256_set1_epi32(0x03));
+
+    wins = _mm256_sub_ps(_mm256_set1_ps(3.0f), inSum);
+    near = _mm256_or_ps(_mm256_cmp_ps(wins, aScore, _CMP_LT_OQ), _mm256_cmp_ps(wins, bScore, _CMP_LT_OQ));
+    closest = _mm256_blendv_epi8(aPoint, bPoint, _mm256_castps_si256(_mm256_cmp_ps(bScore, aScore, _CMP_LT_OQ)));
+    c = _mm256_blendv_epi8(_mm256_and_si256(aPoint, bPoint), closest, _mm256_castps_si256(near));
+    __m256i keyUpper = _mm256_or_si256(_mm256_set1_epi32(1 << 6), _mm256_slli_epi32(c, 3));
+
+    /* Octahedron: the closest two of its six vertices, found through the three opposite pairs. */
+    __m256 p1 = _mm256_add_ps(xins, yins);
+    __m256 p1Further = _mm256_cmp_ps(p1, one, _CMP_GT_OQ);
+    aScore = _mm256_blendv_ps(_mm256_sub_ps(one, p1), _mm256_sub_ps(p1, one), p1Further);
+    aPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x04), _mm256_set1_epi32(0x03 | 0x08), _mm256_castps_si256(p1Further));
+
+    __m256 p2 = _mm256_add_ps(xins, zins);
+    __m256 p2Further = _mm256_cmp_ps(p2, one, _CMP_GT_OQ);
+    bScore = _mm256_blendv_ps(_mm256_sub_ps(one, p2), _mm256_sub_ps(p2, one), p2Further);
+    bPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x02), _mm256_set1_epi32(0x05 | 0x08), _mm256_castps_si256(p2Further));
+
+    __m256 p3 = _mm256_add_ps(yins, zins);
+    __m256 p3Further = _mm256_cmp_ps(p3, one, _CMP_GT_OQ);
+    __m256 score = _mm256_blendv_ps(_mm256_sub_ps(one, p3), _mm256_sub_ps(p3, one), p3Further);
+    __m256i point = _mm256_blendv_epi8(_mm256_set1_epi32(0x01), _mm256_set1_epi32(0x06 | 0x08), _mm256_castps_si256(p3Further));
+
+    /* Unlike the tetrahedra, ties here replace a rather than b. */
+    __m256 replaceA = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_LE_OQ), _mm256_cmp_ps(aScore, score, _CMP_LT_OQ));
+    __m256 replaceB = _mm256_and_ps(_mm256_cmp_ps(aScore, bScore, _CMP_GT_OQ), _mm256_cmp_ps(bScore, score, _CMP_LT_OQ));
+    aPoint = _mm256_blendv_epi8(aPoint, point, _mm256_castps_si256(replaceA));
+    bPoint = _mm256_blendv_epi8(bPoint, point, _mm256_castps_si256(replaceB));
+
+    __m256i aFurther = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, further), further);
+    __m256i sameSide = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, further), _mm256_and_si256(bPoint, further));
+    aPoint = _mm256_andnot_si256(further, aPoint);
+    bPoint = _mm256_andnot_si256(further, bPoint);
+
+    c = _mm256_blendv_epi8(_mm256_or_si256(aPoint, bPoint), _mm256_and_si256(aPoint, bPoint), aFurther);
+    __m256i keySame = _mm256_slli_epi32(c, 3);
+    __m256i keyMixed = _mm256_blendv_epi8(_mm256_or_si256(_mm256_slli_epi32(bPoint, 3), aPoint),
+                                          _mm256_or_si256(_mm256_slli_epi32(aPoint, 3), bPoint), aFurther);
+    __m256i keyMiddle = _mm256_or_si256(_mm256_set1_epi32(2 << 6), _mm256_blendv_epi8(keyMixed, keySame, sameSide));
+
+    __m256i lower = _mm256_castps_si256(_mm256_cmp_ps(inSum, one, _CMP_LE_OQ));
+    __m256i upper = _mm256_castps_si256(_mm256_cmp_ps(inSum, _mm256_set1_ps(2.0f), _CMP_GE_OQ));
+    return _mm256_blendv_epi8(_mm256_blendv_epi8(keyMiddle, keyUpper, upper), keyLower, lower);
+}
+
+/*
+ * Runs the closest-vertex selection of Noise::noise4 for every region and
+ * returns the extraVertexIndex4D key of the region each lane is in.
+ */
+__m256i NoiseBatch::classify4AVX2(__m256 xins, __m256 yins, __m256 zins, __m256 wins, __m256 inSum)
+{
+    const __m256i bigger = _mm256_set1_epi32(0x10); /* Marks a point on the bigger side, above the 4-bit vertex mask. */
+
+    /* Pentachoron at (0,0,0,0) */
+    __m256 aScore = xins;
+    __m256 bScore = yins;
+    __m256i aPoint = _mm256_set1_epi32(0x01);
+    __m256i bPoint = _mm256_set1_epi32(0x02);
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, zins, _mm256_set1_epi32(0x04));
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, wins, _mm256_set1_epi32(0x08));
+
+    __m256 uins = _mm256_sub_ps(_mm256_set1_ps(1.0f), inSum);
+    __m256 near = _mm256_or_ps(_mm256_cmp_ps(uins, aScore, _CMP_GT_OQ), _mm256_cmp_ps(uins, bScore, _CMP_GT_OQ));
+    __m256i closest = _mm256_blendv_epi8(aPoint, bPoint, _mm256_castps_si256(_mm256_cmp_ps(bScore, aScore, _CMP_GT_OQ)));
+    __m256i c = _mm256_blendv_epi8(_mm256_or_si256(aPoint, bPoint), closest, _mm256_castps_si256(near));
+    __m256i key0 = _mm256_slli_epi32(c, 4);
+
+    /* Pentachoron at (1,1,1,1) */
+    aScore = xins;
+    bScore = yins;
+    aPoint = _mm256_set1_epi32(0x0E);
+    bPoint = _mm256_set1_epi32(0x0D);
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, zins, _mm256_set1_epi32(0x0B));
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, wins, _mm256_set1_epi32(0x07));
+
+    uins = _mm256_sub_ps(_mm256_set1_ps(4.0f), inSum);
+    near = _mm256_or_ps(_mm256_cmp_ps(uins, aScore, _CMP_LT_OQ), _mm256_cmp_ps(uins, bScore, _CMP_LT_OQ));
+    closest = _mm256_blendv_epi8(aPoint, bPoint, _mm256_castps_si256(_mm256_cmp_ps(bScore, aScore, _CMP_LT_OQ)));
+    c = _mm256_blendv_epi8(_mm256_and_si256(aPoint, bPoint), closest, _mm256_castps_si256(near));
+    __m256i key1 = _mm256_or_si256(_mm256_set1_epi32(1 << 8), _mm256_slli_epi32(c, 4));
+
+    /* First dispentachoron */
+    __m256 xy = _mm256_add_ps(xins, yins);
+    __m256 zw = _mm256_add_ps(zins, wins);
+    __m256 xz = _mm256_add_ps(xins, zins);
+    __m256 yw = _mm256_add_ps(yins, wins);
+    __m256 xw = _mm256_add_ps(xins, wins);
+    __m256 yz = _mm256_add_ps(yins, zins);
+
+    __m256 mask = _mm256_cmp_ps(xy, zw, _CMP_GT_OQ);
+    aScore = _mm256_blendv_ps(zw, xy, mask);
+    aPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x0C | 0x10), _mm256_set1_epi32(0x03 | 0x10), _mm256_castps_si256(mask));
+    mask = _mm256_cmp_ps(xz, yw, _CMP_GT_OQ);
+    bScore = _mm256_blendv_ps(yw, xz, mask);
+    bPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x0A | 0x10), _mm256_set1_epi32(0x05 | 0x10), _mm256_castps_si256(mask));
+    mask = _mm256_cmp_ps(xw, yz, _CMP_GT_OQ);
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, _mm256_blendv_ps(yz, xw, mask),
+                       _mm256_blendv_epi8(_mm256_set1_epi32(0x06 | 0x10), _mm256_set1_epi32(0x09 | 0x10), _mm256_castps_si256(mask)));
+
+    __m256 remainder = _mm256_sub_ps(_mm256_set1_ps(2.0f), inSum);
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, xins), _mm256_set1_epi32(0x01));
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, yins), _mm256_set1_epi32(0x02));
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, zins), _mm256_set1_epi32(0x04));
+    closestGreaterAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, wins), _mm256_set1_epi32(0x08));
+
+    __m256i aBigger = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, bigger), bigger);
+    __m256i sameSide = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, bigger), _mm256_and_si256(bPoint, bigger));
+    aPoint = _mm256_andnot_si256(bigger, aPoint);
+    bPoint = _mm256_andnot_si256(bigger, bPoint);
+
+    __m256i keySame = _mm256_or_si256(_mm256_slli_epi32(_mm256_or_si256(aPoint, bPoint), 4),
+                                      _mm256_and_si256(aBigger, _mm256_and_si256(aPoint, bPoint)));
+    __m256i keyMixed = _mm256_blendv_epi8(_mm256_or_si256(_mm256_slli_epi32(bPoint, 4), aPoint),
+                                          _mm256_or_si256(_mm256_slli_epi32(aPoint, 4), bPoint), aBigger);
+    __m256i key2 = _mm256_or_si256(_mm256_set1_epi32(2 << 8), _mm256_blendv_epi8(keyMixed, keySame, sameSide));
+
+    /* Second dispentachoron */
+    mask = _mm256_cmp_ps(xy, zw, _CMP_LT_OQ);
+    aScore = _mm256_blendv_ps(zw, xy, mask);
+    aPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x03 | 0x10), _mm256_set1_epi32(0x0C | 0x10), _mm256_castps_si256(mask));
+    mask = _mm256_cmp_ps(xz, yw, _CMP_LT_OQ);
+    bScore = _mm256_blendv_ps(yw, xz, mask);
+    bPoint = _mm256_blendv_epi8(_mm256_set1_epi32(0x05 | 0x10), _mm256_set1_epi32(0x0A | 0x10), _mm256_castps_si256(mask));
+    mask = _mm256_cmp_ps(xw, yz, _CMP_LT_OQ);
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, _mm256_blendv_ps(yz, xw, mask),
+                       _mm256_blendv_epi8(_mm256_set1_epi32(0x09 | 0x10), _mm256_set1_epi32(0x06 | 0x10), _mm256_castps_si256(mask)));
+
+    remainder = _mm256_sub_ps(_mm256_set1_ps(3.0f), inSum);
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, xins), _mm256_set1_epi32(0x0E));
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, yins), _mm256_set1_epi32(0x0D));
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, zins), _mm256_set1_epi32(0x0B));
+    closestSmallerAVX2(aScore, aPoint, bScore, bPoint, _mm256_add_ps(remainder, wins), _mm256_set1_epi32(0x07));
+
+    aBigger = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, bigger), bigger);
+    sameSide = _mm256_cmpeq_epi32(_mm256_and_si256(aPoint, bigger), _mm256_and_si256(bPoint, bigger));
+    aPoint = _mm256_andnot_si256(bigger, aPoint);
+    bPoint = _mm256_andnot_si256(bigger, bPoint);
+
+    keySame = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(aPoint, bPoint), 4),
+                              _mm256_and_si256(aBigger, _mm256_or_si256(aPoint, bPoint)));
+    keyMixed = _mm256_blendv_epi8(_mm256_or_si256(_mm256_slli_epi32(bPoint, 4), aPoint),
+                                  _mm256_or_si256(_mm256_slli_epi32(aPoint, 4), bPoint), aBigger);
+    __m256i key3 = _mm256_or_si256(_mm256_set1_epi32(3 << 8), _mm256_blendv_epi8(keyMixed, keySame, sameSide));
+
+    __m256i region0 = _mm256_castps_si256(_mm256_cmp_ps(inSum, _mm256_set1_ps(1.0f), _CMP_LE_OQ));
+    __m256i region1 = _mm256_castps_si256(_mm256_cmp_ps(inSum, _mm256_set1_ps(3.0f), _CMP_GE_OQ));
+    __m256i region2 = _mm256_castps_si256(_mm256_cmp_ps(inSum, _mm256_set1_ps(2.0f), _CMP_LE_OQ));
+    __m256i key = _mm256_blendv_epi8(key3, key2, region2);
+    key = _mm256_blendv_epi8(key, key1, region1);
+    return _mm256_blendv_epi8(key, key0, region0);
+}
+
+/*
+ * The packed 3D gradient at lattice vertex (x, y, z), from the words
+ * packGradients3D filled in.
+ */
+__m256i NoiseBatch::gradient3AVX2(const Context& ctx, const int32_t* gradients, __m256i x, __m256i y, __m256i z)
+{
+    __m256i hash = permAVX2(ctx, _mm256_add_epi32(permAVX2(ctx, x), y));
+    hash = _mm256_and_si256(_mm256_add_epi32(hash, z), _mm256_set1_epi32(0xFF));
+    return _mm256_i32gather_epi32((const int*) gradients, hash, 4);
+}
+
+/* The 24 packed gradients fit in three registers, so they are permuted rather than gathered. */
+__m256i NoiseBatch::gradient3AVX2(const HashContext& ctx, const int32_t* gradients, __m256i x, __m256i y, __m256i z)
+{
+    __m256i hash = _mm256_srli_epi32(hashAVX2(ctx, x, y, z, _mm256_setzero_si256()), 16);
+    __m256i index = _mm256_srli_epi32(_mm256_mullo_epi32(hash, _mm256_set1_epi32(24)), 16);
+    __m256i low = _mm256_permutevar8x32_epi32(_mm256_load_si256((const __m256i*) gradients), index);
+    __m256i middle = _mm256_permutevar8x32_epi32(_mm256_load_si256((const __m256i*) (gradients + 8)), index);
+    __m256i high = _mm256_permutevar8x32_epi32(_mm256_load_si256((const __m256i*) (gradients + 16)), index);
+    __m256i gradient = _mm256_blendv_epi8(low, middle, _mm256_cmpgt_epi32(index, _mm256_set1_epi32(7)));
+    return _mm256_blendv_epi8(gradient, high, _mm256_cmpgt_epi32(index, _mm256_set1_epi32(15)));
+}
+
+template <typename ContextType>
+__m256 NoiseBatch::contribution3AVX2(const ContextType& ctx, const int32_t* gradients, __m256 value, __m256i xsb, __m256i ysb, __m256i zsb, __m256 dx0, __m256 dy0, __m256 dz0, __m256i offsets, __m256i lateOffsets)
+{
+    const __m256 squishConstant = _mm256_set1_ps(1.0f / 3.0f);
+
+    __m256i xsv = unpackAVX2(offsets, 0);
+    __m256i ysv = unpackAVX2(offsets, 1);
+    __m256i zsv = unpackAVX2(offsets, 2);
+
+    __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(xsv, ysv), zsv)), squishConstant);
+    __m256 dx, dy, dz;
+    /* Only a few extra vertices have a late part, so skip it for the rest. */
+    if (_mm256_testz_si256(lateOffsets, lateOffsets)) {
+        dx = _mm256_sub_ps(_mm256_sub_ps(dx0, _mm256_cvtepi32_ps(xsv)), squishOffset);
+        dy = _mm256_sub_ps(_mm256_sub_ps(dy0, _mm256_cvtepi32_ps(ysv)), squishOffset);
+        dz = _mm256_sub_ps(_mm256_sub_ps(dz0, _mm256_cvtepi32_ps(zsv)), squishOffset);
+    } else {
+        __m256i xsvLate = unpackAVX2(lateOffsets, 0);
+        __m256i ysvLate = unpackAVX2(lateOffsets, 1);
+        __m256i zsvLate = unpackAVX2(lateOffsets, 2);
+        dx = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dx0, _mm256_cvtepi32_ps(_mm256_sub_epi32(xsv, xsvLate))), squishOffset), _mm256_cvtepi32_ps(xsvLate));
+        dy = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dy0, _mm256_cvtepi32_ps(_mm256_sub_epi32(ysv, ysvLate))), squishOffset), _mm256_cvtepi32_ps(ysvLate));
+        dz = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dz0, _mm256_cvtepi32_ps(_mm256_sub_epi32(zsv, zsvLate))), squishOffset), _mm256_cvtepi32_ps(zsvLate));
+    }
+    __m256 attn = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(dx, dx)), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+    __m256 mask = _mm256_cmp_ps(attn, _mm256_setzero_ps(), _CMP_GT_OQ);
+    if (_mm256_movemask_ps(mask) == 0)
+        return value;
+
+    __m256i gradient = gradient3AVX2(ctx, gradients, _mm256_add_epi32(xsb, xsv), _mm256_add_epi32(ysb, ysv), _mm256_add_epi32(zsb, zsv));
+
+    __m256 extrapolation = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 0)), dx),
+                                                       _mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 1)), dy)),
+                                         _mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 2)), dz));
+    attn = _mm256_mul_ps(attn, attn);
+    return _mm256_add_ps(value, _mm256_and_ps(mask, _mm256_mul_ps(_mm256_mul_ps(attn, attn), extrapolation)));
+}
+
+/*
+ * The byte offset into gradients4D of the gradient at lattice vertex
+ * (x, y, z, w).
+ */
+__m256i NoiseBatch::gradient4AVX2(const Context& ctx, __m256i x, __m256i y, __m256i z, __m256i w)
+{
+    __m256i hash = permAVX2(ctx, _mm256_add_epi32(permAVX2(ctx, x), y));
+    hash = permAVX2(ctx, _mm256_add_epi32(permAVX2(ctx, _mm256_add_epi32(hash, z)), w));
+    return _mm256_and_si256(hash, _mm256_set1_epi32(0xFC));
+}
+
+__m256i NoiseBatch::gradient4AVX2(const HashContext& ctx, __m256i x, __m256i y, __m256i z, __m256i w)
+{
+    return _mm256_slli_epi32(_mm256_srli_epi32(hashAVX2(ctx, x, y, z, w), 26), 2);
+}
+
+template <typename ContextType>
+__m256 NoiseBatch::contribution4AVX2(const ContextType& ctx, __m256 value, __m256i xsb, __m256i ysb, __m256i zsb, __m256i wsb, __m256 dx0, __m256 dy0, __m256 dz0, __m256 dw0, __m256i offsets, __m256i lateOffsets)
+{
+    const __m256 squishConstant = _mm256_set1_ps(0.309016994374947f);
+
+    __m256i xsv = unpackAVX2(offsets, 0);
+    __m256i ysv = unpackAVX2(offsets, 1);
+    __m256i zsv = unpackAVX2(offsets, 2);
+    __m256i wsv = unpackAVX2(offsets, 3);
+
+    __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(xsv, ysv), zsv), wsv)), squishConstant);
+    __m256 dx, dy, dz, dw;
+    /* Only a few extra vertices have a late part, so skip it for the rest. */
+    if (_mm256_testz_si256(lateOffsets, lateOffsets)) {
+        dx = _mm256_sub_ps(_mm256_sub_ps(dx0, _mm256_cvtepi32_ps(xsv)), squishOffset);
+        dy = _mm256_sub_ps(_mm256_sub_ps(dy0, _mm256_cvtepi32_ps(ysv)), squishOffset);
+        dz = _mm256_sub_ps(_mm256_sub_ps(dz0, _mm256_cvtepi32_ps(zsv)), squishOffset);
+        dw = _mm256_sub_ps(_mm256_sub_ps(dw0, _mm256_cvtepi32_ps(wsv)), squishOffset);
+    } else {
+        __m256i xsvLate = unpackAVX2(lateOffsets, 0);
+        __m256i ysvLate = unpackAVX2(lateOffsets, 1);
+        __m256i zsvLate = unpackAVX2(lateOffsets, 2);
+        __m256i wsvLate = unpackAVX2(lateOffsets, 3);
+        dx = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dx0, _mm256_cvtepi32_ps(_mm256_sub_epi32(xsv, xsvLate))), squishOffset), _mm256_cvtepi32_ps(xsvLate));
+        dy = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dy0, _mm256_cvtepi32_ps(_mm256_sub_epi32(ysv, ysvLate))), squishOffset), _mm256_cvtepi32_ps(ysvLate));
+        dz = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dz0, _mm256_cvtepi32_ps(_mm256_sub_epi32(zsv, zsvLate))), squishOffset), _mm256_cvtepi32_ps(zsvLate));
+        dw = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(dw0, _mm256_cvtepi32_ps(_mm256_sub_epi32(wsv, wsvLate))), squishOffset), _mm256_cvtepi32_ps(wsvLate));
+    }
+    __m256 attn = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(dx, dx)), _mm256_mul_ps(dy, dy)),
+                                              _mm256_mul_ps(dz, dz)), _mm256_mul_ps(dw, dw));
+    __m256 mask = _mm256_cmp_ps(attn, _mm256_setzero_ps(), _CMP_GT_OQ);
+    if (_mm256_movemask_ps(mask) == 0)
+        return value;
+
+    __m256i offset = gradient4AVX2(ctx, _mm256_add_epi32(xsb, xsv), _mm256_add_epi32(ysb, ysv),
+                                   _mm256_add_epi32(zsb, zsv), _mm256_add_epi32(wsb, wsv));
+
+    /* The four components of a 4D gradient are consecutive bytes, so one 32-bit gather reads them all. */
+    __m256i gradient = _mm256_i32gather_epi32((const int*) gradients4D, offset, 1);
+
+    __m256 extrapolation = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 0)), dx),
+                                                                     _mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 1)), dy)),
+                                                       _mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 2)), dz)),
+                                         _mm256_mul_ps(_mm256_cvtepi32_ps(unpackAVX2(gradient, 3)), dw));
+    attn = _mm256_mul_ps(attn, attn);
+    return _mm256_add_ps(value, _mm256_and_ps(mask, _mm256_mul_ps(_mm256_mul_ps(attn, attn), extrapolation)));
+}
+
+template <typename ContextType>
+void NoiseBatch::noise3AVX2(const ContextType& ctx, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+{
+    const __m256 stretchConstant = _mm256_set1_ps(-1.0f / 6.0f);
+    const __m256 squishConstant = _mm256_set1_ps(1.0f / 3.0f);
+    const __m256 normConstant = _mm256_set1_ps(103.0f);
+    alignas(64) int32_t gradients[256];
+    if (count >= 8)
+        packGradients3D(ctx, gradients);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+
+        /* Place input coordinates on simplectic honeycomb. */
+        __m256 stretchOffset = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), stretchConstant);
+        __m256 xs8 = _mm256_add_ps(x, stretchOffset);
+        __m256 ys8 = _mm256_add_ps(y, stretchOffset);
+        __m256 zs8 = _mm256_add_ps(z, stretchOffset);
+
+        /* Floor to get simplectic honeycomb coordinates of rhombohedron (stretched cube) super-cell origin. */
+        __m256i xsb = floorAVX2(xs8);
+        __m256i ysb = floorAVX2(ys8);
+        __m256i zsb = floorAVX2(zs8);
+        __m256 xsbf = _mm256_cvtepi32_ps(xsb);
+        __m256 ysbf = _mm256_cvtepi32_ps(ysb);
+        __m256 zsbf = _mm256_cvtepi32_ps(zsb);
+
+        /* Skew out to get actual coordinates of rhombohedron origin. */
+        __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(xsb, ysb), zsb)), squishConstant);
+        __m256 dx0 = _mm256_sub_ps(x, _mm256_add_ps(xsbf, squishOffset));
+        __m256 dy0 = _mm256_sub_ps(y, _mm256_add_ps(ysbf, squishOffset));
+        __m256 dz0 = _mm256_sub_ps(z, _mm256_add_ps(zsbf, squishOffset));
+
+        /* Compute simplectic honeycomb coordinates relative to rhombohedral origin and the region selector. */
+        __m256 xins = _mm256_sub_ps(xs8, xsbf);
+        __m256 yins = _mm256_sub_ps(ys8, ysbf);
+        __m256 zins = _mm256_sub_ps(zs8, zsbf);
+        __m256 inSum = _mm256_add_ps(_mm256_add_ps(xins, yins), zins);
+
+        __m256i key = classify3AVX2(xins, yins, zins, inSum);
+        __m256i region = _mm256_srli_epi32(key, 6);
+        __m256i upper = _mm256_cmpeq_epi32(region, _mm256_set1_epi32(1));
+        __m256i middle = _mm256_cmpeq_epi32(region, _mm256_set1_epi32(2));
+
+        /* The vertices of the region itself. Only the octahedron has more than four. */
+        int vertexCount = _mm256_movemask_epi8(middle) ? regionVertexCount3D[2] : regionVertexCount3D[0];
+        __m256 value = _mm256_setzero_ps();
+        for (int k = 0; k < vertexCount; k++) {
+            __m256i offsets = _mm256_blendv_epi8(_mm256_blendv_epi8(_mm256_set1_epi32(packOffsets(regionVertices3D[0][k])),
+                                                                    _mm256_set1_epi32(packOffsets(regionVertices3D[1][k])), upper),
+                                                 _mm256_set1_epi32(packOffsets(regionVertices3D[2][k])), middle);
+            __m256i lateOffsets = _mm256_blendv_epi8(_mm256_blendv_epi8(_mm256_set1_epi32(packLateOffsets(regionVertices3D[0][k])),
+                                                                        _mm256_set1_epi32(packLateOffsets(regionVertices3D[1][k])), upper),
+                                                     _mm256_set1_epi32(packLateOffsets(regionVertices3D[2][k])), middle);
+            value = contribution3AVX2(ctx, gradients, value, xsb, ysb, zsb, dx0, dy0, dz0, offsets, lateOffsets);
+        }
+
+        /* The two extra vertices. */
+        __m256i extra = _mm256_and_si256(_mm256_i32gather_epi32((const int*) extraVertexIndex3D, key, 1), _mm256_set1_epi32(0xFF));
+        extra = _mm256_add_epi32(extra, extra);
+        for (int k = 0; k < 2; k++) {
+            __m256i index = _mm256_add_epi32(extra, _mm256_set1_epi32(k));
+            __m256i offsets = _mm256_i32gather_epi32((const int*) extraVertices3D, index, 8);
+            __m256i lateOffsets = _mm256_i32gather_epi32((const int*) extraVertices3D + 1, index, 8);
+            value = contribution3AVX2(ctx, gradients, value, xsb, ysb, zsb, dx0, dy0, dz0, offsets, lateOffsets);
+        }
+
+        _mm256_storeu_ps(out + i, _mm256_div_ps(value, normConstant));
+    }
+
+    noise3Scalar(ctx, xs + i, ys + i, zs + i, out + i, count - i);
+}
+
+template <typename ContextType>
+void NoiseBatch::noise4AVX2(const ContextType& ctx, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count)
+{
+    const __m256 stretchConstant = _mm256_set1_ps(-0.138196601125011f);
+    const __m256 squishConstant = _mm256_set1_ps(0.309016994374947f);
+    const __m256 normConstant = _mm256_set1_ps(30.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 z = _mm256_loadu_ps(zs + i);
+        __m256 w = _mm256_loadu_ps(ws + i);
+
+        /* Place input coordinates on simplectic honeycomb. */
+        __m256 stretchOffset = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), w), stretchConstant);
+        __m256 xs8 = _mm256_add_ps(x, stretchOffset);
+        __m256 ys8 = _mm256_add_ps(y, stretchOffset);
+        __m256 zs8 = _mm256_add_ps(z, stretchOffset);
+        __m256 ws8 = _mm256_add_ps(w, stretchOffset);
+
+        /* Floor to get simplectic honeycomb coordinates of rhombo-hypercube super-cell origin. */
+        __m256i xsb = floorAVX2(xs8);
+        __m256i ysb = floorAVX2(ys8);
+        __m256i zsb = floorAVX2(zs8);
+        __m256i wsb = floorAVX2(ws8);
+        __m256 xsbf = _mm256_cvtepi32_ps(xsb);
+        __m256 ysbf = _mm256_cvtepi32_ps(ysb);
+        __m256 zsbf = _mm256_cvtepi32_ps(zsb);
+        __m256 wsbf = _mm256_cvtepi32_ps(wsb);
+
+        /* Skew out to get actual coordinates of stretched rhombo-hypercube origin. */
+        __m256 squishOffset = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(xsb, ysb), zsb), wsb)), squishConstant);
+        __m256 dx0 = _mm256_sub_ps(x, _mm256_add_ps(xsbf, squishOffset));
+        __m256 dy0 = _mm256_sub_ps(y, _mm256_add_ps(ysbf, squishOffset));
+        __m256 dz0 = _mm256_sub_ps(z, _mm256_add_ps(zsbf, squishOffset));
+        __m256 dw0 = _mm256_sub_ps(w, _mm256_add_ps(wsbf, squishOffset));
+
+        /* Compute simplectic honeycomb coordinates relative to rhombo-hypercube origin and the region selector. */
+        __m256 xins = _mm256_sub_ps(xs8, xsbf);
+        __m256 yins = _mm256_sub_ps(ys8, ysbf);
+        __m256 zins = _mm256_sub_ps(zs8, zsbf);
+        __m256 wins = _mm256_sub_ps(ws8, wsbf);
+        __m256 inSum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(xins, yins), zins), wins);
+
+        __m256i key = classify4AVX2(xins, yins, zins, wins, inSum);
+        __m256i region = _mm256_srli_epi32(key, 8);
+        __m256i region1 = _mm256_cmpeq_epi32(region, _mm256_set1_epi32(1));
+        __m256i region2 = _mm256_cmpeq_epi32(region, _mm256_set1_epi32(2));
+        __m256i region3 = _mm256_cmpeq_epi32(region, _mm256_set1_epi32(3));
+
+        /* The vertices of the region itself. Only the dispentachora have more than five. */
+        int vertexCount = _mm256_movemask_epi8(_mm256_or_si256(region2, region3)) ? regionVertexCount4D[2] : regionVertexCount4D[0];
+        __m256 value = _mm256_setzero_ps();
+        for (int k = 0; k < vertexCount; k++) {
+            __m256i offsets = _mm256_set1_epi32(packOffsets(regionVertices4D[0][k]));
+            offsets = _mm256_blendv_epi8(offsets, _mm256_set1_epi32(packOffsets(regionVertices4D[1][k])), region1);
+            offsets = _mm256_blendv_epi8(offsets, _mm256_set1_epi32(packOffsets(regionVertices4D[2][k])), region2);
+            offsets = _mm256_blendv_epi8(offsets, _mm256_set1_epi32(packOffsets(regionVertices4D[3][k])), region3);
+            __m256i lateOffsets = _mm256_set1_epi32(packLateOffsets(regionVertices4D[0][k]));
+            lateOffsets = _mm256_blendv_epi8(lateOffsets, _mm256_set1_epi32(packLateOffsets(regionVertices4D[1][k])), region1);
+            lateOffsets = _mm256_blendv_epi8(lateOffsets, _mm256_set1_epi32(packLateOffsets(regionVertices4D[2][k])), region2);
+            lateOffsets = _mm256_blendv_epi8(lateOffsets, _mm256_set1_epi32(packLateOffsets(regionVertices4D[3][k])), region3);
+            value = contribution4AVX2(ctx, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, offsets, lateOffsets);
+        }
+
+        /* The three extra vertices. */
+        __m256i extra = _mm256_and_si256(_mm256_i32gather_epi32((const int*) extraVertexIndex4D, key, 1), _mm256_set1_epi32(0xFF));
+        extra = _mm256_add_epi32(_mm256_add_epi32(extra, extra), extra);
+        for (int k = 0; k < 3; k++) {
+            __m256i index = _mm256_add_epi32(extra, _mm256_set1_epi32(k));
+            __m256i offsets = _mm256_i32gather_epi32((const int*) extraVertices4D, index, 8);
+            __m256i lateOffsets = _mm256_i32gather_epi32((const int*) extraVertices4D + 1, index, 8);
+            value = contribution4AVX2(ctx, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, offsets, lateOffsets);
+        }
+
+        _mm256_storeu_ps(out + i, _mm256_div_ps(value, normConstant));
+    }
+
+    noise4Scalar(ctx, xs + i, ys + i, zs + i, ws + i, out + i, count - i);
+}
+
+/*
+ * The AVX-512 kernels are the AVX2 ones over sixteen lanes, with lane masks
+ * in mask registers rather than in vectors.
+ */
+
+/*
+ * AVX-512F includes FMA, which GCC would otherwise fuse separate multiplies
+ * and adds into, changing the rounding. GCC 12 also warns about the
+ * uninitialized placeholder its own AVX-512 intrinsics pass through (GCC bug
+ * 105593).
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC push_options
+    #pragma GCC optimize("fp-contract=off")
+#endif
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ == 12
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__m512i NoiseBatch::floorAVX512(__m512 x)
+{
+    __m512i xi = _mm512_cvttps_epi32(x);
+    return _mm512_mask_sub_epi32(xi, _mm512_cmp_ps_mask(x, _mm512_cvtepi32_ps(xi), _CMP_LT_OQ), xi, _mm512_set1_epi32(1));
+}
+
+__m512i NoiseBatch::permAVX512(const Context& ctx, __m512i index)
+{
+    __m512i words = _mm512_i32gather_epi32(_mm512_and_si512(index, _mm512_set1_epi32(0xFF)), (const void*) ctx.perm, 2);
+    return _mm512_and_si512(words, _mm512_set1_epi32(0xFFFF));
+}
+
+__m512i NoiseBatch::hashAVX512(const HashContext& ctx, __m512i x, __m512i y, __m512i z, __m512i w)
+{
+    __m512i h = _mm512_add_epi32(_mm512_set1_epi32((int32_t) ctx.seed), _mm512_mullo_epi32(x, _mm512_set1_epi32((int32_t) 0x8DA6B343u)));
+    h = _mm512_add_epi32(h, _mm512_mullo_epi32(y, _mm512_set1_epi32((int32_t) 0xD8163841u)));
+    h = _mm512_add_epi32(h, _mm512_mullo_epi32(z, _mm512_set1_epi32((int32_t) 0xCB1AB31Fu)));
+    h = _mm512_add_epi32(h, _mm512_mullo_epi32(w, _mm512_set1_epi32((int32_t) 0x165667B1u)));
+    h = _mm512_mullo_epi32(_mm512_xor_si512(h, _mm512_srli_epi32(h, 16)), _mm512_set1_epi32((int32_t) 0x85EBCA6Bu));
+    return _mm512_mullo_epi32(_mm512_xor_si512(h, _mm512_srli_epi32(h, 13)), _mm512_set1_epi32((int32_t) 0xC2B2AE35u));
+}
+
+__m512i NoiseBatch::gradient3AVX512(const Context& ctx, const int32_t* gradients, __m512i x, __m512i y, __m512i z)
+{
+    __m512i hash = permAVX512(ctx, _mm512_add_epi32(permAVX512(ctx, x), y));
+    hash = _mm512_and_si512(_mm512_add_epi32(hash, z), _mm512_set1_epi32(0xFF));
+    return _mm512_i32gather_epi32(hash, (const void*) gradients, 4);
+}
+
+/* The 24 packed gradients fit in two registers, so they are permuted rather than gathered. */
+__m512i NoiseBatch::gradient3AVX512(const HashContext& ctx, const int32_t* gradients, __m512i x, __m512i y, __m512i z)
+{
+    __m512i hash = _mm512_srli_epi32(hashAVX512(ctx, x, y, z, _mm512_setzero_si512()), 16);
+    __m512i index = _mm512_srli_epi32(_mm512_mullo_epi32(hash, _mm512_set1_epi32(24)), 16);
+    return _mm512_permutex2var_epi32(_mm512_load_si512((const void*) gradients), index,
+                                     _mm512_load_si512((const void*) (gradients + 16)));
+}
+
+/*
+ * The number (0 to 63) of the 4D gradient at lattice vertex (x, y, z, w).
+ */
+__m512i NoiseBatch::gradient4AVX512(const Context& ctx, __m512i x, __m512i y, __m512i z, __m512i w)
+{
+    __m512i hash = permAVX512(ctx, _mm512_add_epi32(permAVX512(ctx, x), y));
+    hash = permAVX512(ctx, _mm512_add_epi32(permAVX512(ctx, _mm512_add_epi32(hash, z)), w));
+    return _mm512_srli_epi32(_mm512_and_si512(hash, _mm512_set1_epi32(0xFC)), 2);
+}
+
+__m512i NoiseBatch::gradient4AVX512(const HashContext& ctx, __m512i x, __m512i y, __m512i z, __m512i w)
+{
+    return _mm512_srli_epi32(hashAVX512(ctx, x, y, z, w), 26);
+}
+
+__m512i NoiseBatch::unpackAVX512(__m512i packed, int axis)
+{
+    return _mm512_srai_epi32(_mm512_sll_epi32(packed, _mm_cvtsi32_si128(24 - 8 * axis)), 24);
+}
+
+void NoiseBatch::closestGreaterAVX512(__m512& aScore, __m512i& aPoint, __m512& bScore, __m512i& bPoint, __m512 score, __m512i point)
+{
+    __mmask16 replaceB = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_GE_OQ), score, bScore, _CMP_GT_OQ);
+    __mmask16 replaceA = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_LT_OQ), score, aScore, _CMP_GT_OQ);
+    bScore = _mm512_mask_blend_ps(replaceB, bScore, score);
+    bPoint = _mm512_mask_blend_epi32(replaceB, bPoint, point);
+    aScore = _mm512_mask_blend_ps(replaceA, aScore, score);
+    aPoint = _mm512_mask_blend_epi32(replaceA, aPoint, point);
+}
+
+void NoiseBatch::closestSmallerAVX512(__m512& aScore, __m512i& aPoint, __m512& bScore, __m512i& bPoint, __m512 score, __m512i point)
+{
+    __mmask16 replaceB = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_LE_OQ), score, bScore, _CMP_LT_OQ);
+    __mmask16 replaceA = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_GT_OQ), score, aScore, _CMP_LT_OQ);
+    bScore = _mm512_mask_blend_ps(replaceB, bScore, score);
+    bPoint = _mm512_mask_blend_epi32(replaceB, bPoint, point);
+    aScore = _mm512_mask_blend_ps(replaceA, aScore, score);
+    aPoint = _mm512_mask_blend_epi32(replaceA, aPoint, point);
+}
+
+__m512i NoiseBatch::classify3AVX512(__m512 xins, __m512 yins, __m512 zins, __m512 inSum)
+{
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512i further = _mm512_set1_epi32(0x08);
+
+    /* Tetrahedron at (0,0,0) */
+    __m512 aScore = xins;
+    __m512 bScore = yins;
+    __m512i aPoint = _mm512_set1_epi32(0x01);
+    __m512i bPoint = _mm512_set1_epi32(0x02);
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, zins, _mm512_set1_epi32(0x04));
+
+    __m512 wins = _mm512_sub_ps(one, inSum);
+    __mmask16 near = _mm512_cmp_ps_mask(wins, aScore, _CMP_GT_OQ) | _mm512_cmp_ps_mask(wins, bScore, _CMP_GT_OQ);
+    __m512i closest = _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(bScore, aScore, _CMP_GT_OQ), aPoint, bPoint);
+    __m512i c = _mm512_mask_blend_epi32(near, _mm512_or_si512(aPoint, bPoint), closest);
+    __m512i keyLower = _mm512_slli_epi32(c, 3);
+
+    /* Tetrahedron at (1,1,1) */
+    aScore = xins;
+    bScore = yins;
+    aPoint = _mm512_set1_epi32(0x06);
+    bPoint = _mm512_set1_epi32(0x05);
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, zins, _mm512_set1_epi32(0x03));
+
+    wins = _mm512_sub_ps(_mm512_set1_ps(3.0f), inSum);
+    near = _mm512_cmp_ps_mask(wins, aScore, _CMP_LT_OQ) | _mm512_cmp_ps_mask(wins, bScore, _CMP_LT_OQ);
+    closest = _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(bScore, aScore, _CMP_LT_OQ), aPoint, bPoint);
+    c = _mm512_mask_blend_epi32(near, _mm512_and_si512(aPoint, bPoint), closest);
+    __m512i keyUpper = _mm512_or_si512(_mm512_set1_epi32(1 << 6), _mm512_slli_epi32(c, 3));
+
+    /* Octahedron */
+    __m512 p1 = _mm512_add_ps(xins, yins);
+    __mmask16 p1Further = _mm512_cmp_ps_mask(p1, one, _CMP_GT_OQ);
+    aScore = _mm512_mask_blend_ps(p1Further, _mm512_sub_ps(one, p1), _mm512_sub_ps(p1, one));
+    aPoint = _mm512_mask_blend_epi32(p1Further, _mm512_set1_epi32(0x04), _mm512_set1_epi32(0x03 | 0x08));
+
+    __m512 p2 = _mm512_add_ps(xins, zins);
+    __mmask16 p2Further = _mm512_cmp_ps_mask(p2, one, _CMP_GT_OQ);
+    bScore = _mm512_mask_blend_ps(p2Further, _mm512_sub_ps(one, p2), _mm512_sub_ps(p2, one));
+    bPoint = _mm512_mask_blend_epi32(p2Further, _mm512_set1_epi32(0x02), _mm512_set1_epi32(0x05 | 0x08));
+
+    __m512 p3 = _mm512_add_ps(yins, zins);
+    __mmask16 p3Further = _mm512_cmp_ps_mask(p3, one, _CMP_GT_OQ);
+    __m512 score = _mm512_mask_blend_ps(p3Further, _mm512_sub_ps(one, p3), _mm512_sub_ps(p3, one));
+    __m512i point = _mm512_mask_blend_epi32(p3Further, _mm512_set1_epi32(0x01), _mm512_set1_epi32(0x06 | 0x08));
+
+    __mmask16 replaceA = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_LE_OQ), aScore, score, _CMP_LT_OQ);
+    __mmask16 replaceB = _mm512_mask_cmp_ps_mask(_mm512_cmp_ps_mask(aScore, bScore, _CMP_GT_OQ), bScore, score, _CMP_LT_OQ);
+    aPoint = _mm512_mask_blend_epi32(replaceA, aPoint, point);
+    bPoint = _mm512_mask_blend_epi32(replaceB, bPoint, point);
+
+    __mmask16 aFurther = _mm512_test_epi32_mask(aPoint, further);
+    __mmask16 sameSide = (__mmask16) ~(aFurther ^ _mm512_test_epi32_mask(bPoint, further));
+    aPoint = _mm512_andnot_si512(further, aPoint);
+    bPoint = _mm512_andnot_si512(further, bPoint);
+
+    c = _mm512_mask_blend_epi32(aFurther, _mm512_or_si512(aPoint, bPoint), _mm512_and_si512(aPoint, bPoint));
+    __m512i keySame = _mm512_slli_epi32(c, 3);
+    __m512i keyMixed = _mm512_mask_blend_epi32(aFurther, _mm512_or_si512(_mm512_slli_epi32(bPoint, 3), aPoint),
+                                               _mm512_or_si512(_mm512_slli_epi32(aPoint, 3), bPoint));
+    __m512i keyMiddle = _mm512_or_si512(_mm512_set1_epi32(2 << 6), _mm512_mask_blend_epi32(sameSide, keyMixed, keySame));
+
+    __mmask16 lower = _mm512_cmp_ps_mask(inSum, one, _CMP_LE_OQ);
+    __mmask16 upper = _mm512_cmp_ps_mask(inSum, _mm512_set1_ps(2.0f), _CMP_GE_OQ);
+    return _mm512_mask_blend_epi32(lower, _mm512_mask_blend_epi32(upper, keyMiddle, keyUpper), keyLower);
+}
+
+__m512i NoiseBatch::classify4AVX512(__m512 xins, __m512 yins, __m512 zins, __m512 wins, __m512 inSum)
+{
+    const __m512i bigger = _mm512_set1_epi32(0x10);
+
+    /* Pentachoron at (0,0,0,0) */
+    __m512 aScore = xins;
+    __m512 bScore = yins;
+    __m512i aPoint = _mm512_set1_epi32(0x01);
+    __m512i bPoint = _mm512_set1_epi32(0x02);
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, zins, _mm512_set1_epi32(0x04));
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, wins, _mm512_set1_epi32(0x08));
+
+    __m512 uins = _mm512_sub_ps(_mm512_set1_ps(1.0f), inSum);
+    __mmask16 near = _mm512_cmp_ps_mask(uins, aScore, _CMP_GT_OQ) | _mm512_cmp_ps_mask(uins, bScore, _CMP_GT_OQ);
+    __m512i closest = _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(bScore, aScore, _CMP_GT_OQ), aPoint, bPoint);
+    __m512i c = _mm512_mask_blend_epi32(near, _mm512_or_si512(aPoint, bPoint), closest);
+    __m512i key0 = _mm512_slli_epi32(c, 4);
+
+    /* Pentachoron at (1,1,1,1) */
+    aScore = xins;
+    bScore = yins;
+    aPoint = _mm512_set1_epi32(0x0E);
+    bPoint = _mm512_set1_epi32(0x0D);
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, zins, _mm512_set1_epi32(0x0B));
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, wins, _mm512_set1_epi32(0x07));
+
+    uins = _mm512_sub_ps(_mm512_set1_ps(4.0f), inSum);
+    near = _mm512_cmp_ps_mask(uins, aScore, _CMP_LT_OQ) | _mm512_cmp_ps_mask(uins, bScore, _CMP_LT_OQ);
+    closest = _mm512_mask_blend_epi32(_mm512_cmp_ps_mask(bScore, aScore, _CMP_LT_OQ), aPoint, bPoint);
+    c = _mm512_mask_blend_epi32(near, _mm512_and_si512(aPoint, bPoint), closest);
+    __m512i key1 = _mm512_or_si512(_mm512_set1_epi32(1 << 8), _mm512_slli_epi32(c, 4));
+
+    /* First dispentachoron */
+    __m512 xy = _mm512_add_ps(xins, yins);
+    __m512 zw = _mm512_add_ps(zins, wins);
+    __m512 xz = _mm512_add_ps(xins, zins);
+    __m512 yw = _mm512_add_ps(yins, wins);
+    __m512 xw = _mm512_add_ps(xins, wins);
+    __m512 yz = _mm512_add_ps(yins, zins);
+
+    __mmask16 mask = _mm512_cmp_ps_mask(xy, zw, _CMP_GT_OQ);
+    aScore = _mm512_mask_blend_ps(mask, zw, xy);
+    aPoint = _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x0C | 0x10), _mm512_set1_epi32(0x03 | 0x10));
+    mask = _mm512_cmp_ps_mask(xz, yw, _CMP_GT_OQ);
+    bScore = _mm512_mask_blend_ps(mask, yw, xz);
+    bPoint = _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x0A | 0x10), _mm512_set1_epi32(0x05 | 0x10));
+    mask = _mm512_cmp_ps_mask(xw, yz, _CMP_GT_OQ);
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, _mm512_mask_blend_ps(mask, yz, xw),
+                         _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x06 | 0x10), _mm512_set1_epi32(0x09 | 0x10)));
+
+    __m512 remainder = _mm512_sub_ps(_mm512_set1_ps(2.0f), inSum);
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, xins), _mm512_set1_epi32(0x01));
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, yins), _mm512_set1_epi32(0x02));
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, zins), _mm512_set1_epi32(0x04));
+    closestGreaterAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, wins), _mm512_set1_epi32(0x08));
+
+    __mmask16 aBigger = _mm512_test_epi32_mask(aPoint, bigger);
+    __mmask16 sameSide = (__mmask16) ~(aBigger ^ _mm512_test_epi32_mask(bPoint, bigger));
+    aPoint = _mm512_andnot_si512(bigger, aPoint);
+    bPoint = _mm512_andnot_si512(bigger, bPoint);
+
+    __m512i keySame = _mm512_mask_or_epi32(_mm512_slli_epi32(_mm512_or_si512(aPoint, bPoint), 4), aBigger,
+                                           _mm512_slli_epi32(_mm512_or_si512(aPoint, bPoint), 4), _mm512_and_si512(aPoint, bPoint));
+    __m512i keyMixed = _mm512_mask_blend_epi32(aBigger, _mm512_or_si512(_mm512_slli_epi32(bPoint, 4), aPoint),
+                                               _mm512_or_si512(_mm512_slli_epi32(aPoint, 4), bPoint));
+    __m512i key2 = _mm512_or_si512(_mm512_set1_epi32(2 << 8), _mm512_mask_blend_epi32(sameSide, keyMixed, keySame));
+
+    /* Second dispentachoron */
+    mask = _mm512_cmp_ps_mask(xy, zw, _CMP_LT_OQ);
+    aScore = _mm512_mask_blend_ps(mask, zw, xy);
+    aPoint = _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x03 | 0x10), _mm512_set1_epi32(0x0C | 0x10));
+    mask = _mm512_cmp_ps_mask(xz, yw, _CMP_LT_OQ);
+    bScore = _mm512_mask_blend_ps(mask, yw, xz);
+    bPoint = _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x05 | 0x10), _mm512_set1_epi32(0x0A | 0x10));
+    mask = _mm512_cmp_ps_mask(xw, yz, _CMP_LT_OQ);
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, _mm512_mask_blend_ps(mask, yz, xw),
+                         _mm512_mask_blend_epi32(mask, _mm512_set1_epi32(0x09 | 0x10), _mm512_set1_epi32(0x06 | 0x10)));
+
+    remainder = _mm512_sub_ps(_mm512_set1_ps(3.0f), inSum);
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, xins), _mm512_set1_epi32(0x0E));
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, yins), _mm512_set1_epi32(0x0D));
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, zins), _mm512_set1_epi32(0x0B));
+    closestSmallerAVX512(aScore, aPoint, bScore, bPoint, _mm512_add_ps(remainder, wins), _mm512_set1_epi32(0x07));
+
+    aBigger = _mm512_test_epi32_mask(aPoint, bigger);
+    sameSide = (__mmask16) ~(aBigger ^ _mm512_test_epi32_mask(bPoint, bigger));
+    aPoint = _mm512_andnot_si512(bigger, aPoint);
+    bPoint = _mm512_andnot_si512(bigger, bPoint);
+
+    keySame = _mm512_mask_or_epi32(_mm512_slli_epi32(_mm512_and_si512(aPoint, bPoint), 4), aBigger,
+                                   _mm512_slli_epi32(_mm512_and_si512(aPoint, bPoint), 4), _mm512_or_si512(aPoint, bPoint));
+    keyMixed = _mm512_mask_blend_epi32(aBigger, _mm512_or_si512(_mm512_slli_epi32(bPoint, 4), aPoint),
+                                       _mm512_or_si512(_mm512_slli_epi32(aPoint, 4), bPoint));
+    __m512i key3 = _mm512_or_si512(_mm512_set1_epi32(3 << 8), _mm512_mask_blend_epi32(sameSide, keyMixed, keySame));
+
+    __mmask16 region0 = _mm512_cmp_ps_mask(inSum, _mm512_set1_ps(1.0f), _CMP_LE_OQ);
+    __mmask16 region1 = _mm512_cmp_ps_mask(inSum, _mm512_set1_ps(3.0f), _CMP_GE_OQ);
+    __mmask16 region2 = _mm512_cmp_ps_mask(inSum, _mm512_set1_ps(2.0f), _CMP_LE_OQ);
+    __m512i key = _mm512_mask_blend_epi32(region2, key3, key2);
+    key = _mm512_mask_blend_epi32(region1, key, key1);
+    return _mm512_mask_blend_epi32(region0, key, key0);
+}
+
+template <typename ContextType>
+__m512 NoiseBatch::contribution3AVX512(const ContextType& ctx, const int32_t* gradients, __m512 value, __m512i xsb, __m512i ysb, __m512i zsb, __m512 dx0, __m512 dy0, __m512 dz0, __m512i offsets, __m512i lateOffsets)
+{
+    const __m512 squishConstant = _mm512_set1_ps(1.0f / 3.0f);
+
+    __m512i xsv = unpackAVX512(offsets, 0);
+    __m512i ysv = unpackAVX512(offsets, 1);
+    __m512i zsv = unpackAVX512(offsets, 2);
+
+    __m512 squishOffset = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_add_epi32(xsv, ysv), zsv)), squishConstant);
+    __m512 dx, dy, dz;
+    /* Only a few extra vertices have a late part, so skip it for the rest. */
+    if (_mm512_test_epi32_mask(lateOffsets, lateOffsets) == 0) {
+        dx = _mm512_sub_ps(_mm512_sub_ps(dx0, _mm512_cvtepi32_ps(xsv)), squishOffset);
+        dy = _mm512_sub_ps(_mm512_sub_ps(dy0, _mm512_cvtepi32_ps(ysv)), squishOffset);
+        dz = _mm512_sub_ps(_mm512_sub_ps(dz0, _mm512_cvtepi32_ps(zsv)), squishOffset);
+    } else {
+        __m512i xsvLate = unpackAVX512(lateOffsets, 0);
+        __m512i ysvLate = unpackAVX512(lateOffsets, 1);
+        __m512i zsvLate = unpackAVX512(lateOffsets, 2);
+        dx = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dx0, _mm512_cvtepi32_ps(_mm512_sub_epi32(xsv, xsvLate))), squishOffset), _mm512_cvtepi32_ps(xsvLate));
+        dy = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dy0, _mm512_cvtepi32_ps(_mm512_sub_epi32(ysv, ysvLate))), squishOffset), _mm512_cvtepi32_ps(ysvLate));
+        dz = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dz0, _mm512_cvtepi32_ps(_mm512_sub_epi32(zsv, zsvLate))), squishOffset), _mm512_cvtepi32_ps(zsvLate));
+    }
+    __m512 attn = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(_mm512_set1_ps(2.0f), _mm512_mul_ps(dx, dx)), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+    __mmask16 mask = _mm512_cmp_ps_mask(attn, _mm512_setzero_ps(), _CMP_GT_OQ);
+    if (mask == 0)
+        return value;
+
+    __m512i gradient = gradient3AVX512(ctx, gradients, _mm512_add_epi32(xsb, xsv), _mm512_add_epi32(ysb, ysv), _mm512_add_epi32(zsb, zsv));
+
+    __m512 extrapolation = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 0)), dx),
+                                                       _mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 1)), dy)),
+                                         _mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 2)), dz));
+    attn = _mm512_mul_ps(attn, attn);
+    return _mm512_mask_add_ps(value, mask, value, _mm512_mul_ps(_mm512_mul_ps(attn, attn), extrapolation));
+}
+
+template <typename ContextType>
+__m512 NoiseBatch::contribution4AVX512(const ContextType& ctx, __m512 value, __m512i xsb, __m512i ysb, __m512i zsb, __m512i wsb, __m512 dx0, __m512 dy0, __m512 dz0, __m512 dw0, __m512i offsets, __m512i lateOffsets)
+{
+    const __m512 squishConstant = _mm512_set1_ps(0.309016994374947f);
+
+    __m512i xsv = unpackAVX512(offsets, 0);
+    __m512i ysv = unpackAVX512(offsets, 1);
+    __m512i zsv = unpackAVX512(offsets, 2);
+    __m512i wsv = unpackAVX512(offsets, 3);
+
+    __m512 squishOffset = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_add_epi32(_mm512_add_epi32(xsv, ysv), zsv), wsv)), squishConstant);
+    __m512 dx, dy, dz, dw;
+    /* Only a few extra vertices have a late part, so skip it for the rest. */
+    if (_mm512_test_epi32_mask(lateOffsets, lateOffsets) == 0) {
+        dx = _mm512_sub_ps(_mm512_sub_ps(dx0, _mm512_cvtepi32_ps(xsv)), squishOffset);
+        dy = _mm512_sub_ps(_mm512_sub_ps(dy0, _mm512_cvtepi32_ps(ysv)), squishOffset);
+        dz = _mm512_sub_ps(_mm512_sub_ps(dz0, _mm512_cvtepi32_ps(zsv)), squishOffset);
+        dw = _mm512_sub_ps(_mm512_sub_ps(dw0, _mm512_cvtepi32_ps(wsv)), squishOffset);
+    } else {
+        __m512i xsvLate = unpackAVX512(lateOffsets, 0);
+        __m512i ysvLate = unpackAVX512(lateOffsets, 1);
+        __m512i zsvLate = unpackAVX512(lateOffsets, 2);
+        __m512i wsvLate = unpackAVX512(lateOffsets, 3);
+        dx = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dx0, _mm512_cvtepi32_ps(_mm512_sub_epi32(xsv, xsvLate))), squishOffset), _mm512_cvtepi32_ps(xsvLate));
+        dy = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dy0, _mm512_cvtepi32_ps(_mm512_sub_epi32(ysv, ysvLate))), squishOffset), _mm512_cvtepi32_ps(ysvLate));
+        dz = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dz0, _mm512_cvtepi32_ps(_mm512_sub_epi32(zsv, zsvLate))), squishOffset), _mm512_cvtepi32_ps(zsvLate));
+        dw = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(dw0, _mm512_cvtepi32_ps(_mm512_sub_epi32(wsv, wsvLate))), squishOffset), _mm512_cvtepi32_ps(wsvLate));
+    }
+    __m512 attn = _mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(_mm512_sub_ps(_mm512_set1_ps(2.0f), _mm512_mul_ps(dx, dx)), _mm512_mul_ps(dy, dy)),
+                                              _mm512_mul_ps(dz, dz)), _mm512_mul_ps(dw, dw));
+    __mmask16 mask = _mm512_cmp_ps_mask(attn, _mm512_setzero_ps(), _CMP_GT_OQ);
+    if (mask == 0)
+        return value;
+
+    __m512i gradientIndex = gradient4AVX512(ctx, _mm512_add_epi32(xsb, xsv), _mm512_add_epi32(ysb, ysv),
+                                            _mm512_add_epi32(zsb, zsv), _mm512_add_epi32(wsb, wsv));
+
+    /* gradients4D fits in four registers, so the gradient is permuted out of them rather than gathered. */
+    __m512i lowGradients = _mm512_permutex2var_epi32(_mm512_loadu_si512((const void*) (gradients4D + 0)), gradientIndex,
+                                                     _mm512_loadu_si512((const void*) (gradients4D + 64)));
+    __m512i highGradients = _mm512_permutex2var_epi32(_mm512_loadu_si512((const void*) (gradients4D + 128)), gradientIndex,
+                                                      _mm512_loadu_si512((const void*) (gradients4D + 192)));
+    __m512i gradient = _mm512_mask_blend_epi32(_mm512_test_epi32_mask(gradientIndex, _mm512_set1_epi32(32)), lowGradients, highGradients);
+
+    __m512 extrapolation = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 0)), dx),
+                                                                     _mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 1)), dy)),
+                                                       _mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 2)), dz)),
+                                         _mm512_mul_ps(_mm512_cvtepi32_ps(unpackAVX512(gradient, 3)), dw));
+    attn = _mm512_mul_ps(attn, attn);
+    return _mm512_mask_add_ps(value, mask, value, _mm512_mul_ps(_mm512_mul_ps(attn, attn), extrapolation));
+}
+
+template <typename ContextType>
+void NoiseBatch::noise3AVX512(const ContextType& ctx, const float* xs, const float* ys, const float* zs, float* out, size_t count)
+{
+    const __m512 stretchConstant = _mm512_set1_ps(-1.0f / 6.0f);
+    const __m512 squishConstant = _mm512_set1_ps(1.0f / 3.0f);
+    const __m512 normConstant = _mm512_set1_ps(103.0f);
+    alignas(64) int32_t gradients[256];
+    if (count >= 16)
+        packGradients3D(ctx, gradients);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 x = _mm512_loadu_ps(xs + i);
+        __m512 y = _mm512_loadu_ps(ys + i);
+        __m512 z = _mm512_loadu_ps(zs + i);
+
+        /* Place input coordinates on simplectic honeycomb. */
+        __m512 stretchOffset = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(x, y), z), stretchConstant);
+        __m512 xs16 = _mm512_add_ps(x, stretchOffset);
+        __m512 ys16 = _mm512_add_ps(y, stretchOffset);
+        __m512 zs16 = _mm512_add_ps(z, stretchOffset);
+
+        /* Floor to get simplectic honeycomb coordinates of rhombohedron (stretched cube) super-cell origin. */
+        __m512i xsb = floorAVX512(xs16);
+        __m512i ysb = floorAVX512(ys16);
+        __m512i zsb = floorAVX512(zs16);
+        __m512 xsbf = _mm512_cvtepi32_ps(xsb);
+        __m512 ysbf = _mm512_cvtepi32_ps(ysb);
+        __m512 zsbf = _mm512_cvtepi32_ps(zsb);
+
+        /* Skew out to get actual coordinates of rhombohedron origin. */
+        __m512 squishOffset = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_add_epi32(xsb, ysb), zsb)), squishConstant);
+        __m512 dx0 = _mm512_sub_ps(x, _mm512_add_ps(xsbf, squishOffset));
+        __m512 dy0 = _mm512_sub_ps(y, _mm512_add_ps(ysbf, squishOffset));
+        __m512 dz0 = _mm512_sub_ps(z, _mm512_add_ps(zsbf, squishOffset));
+
+        /* Compute simplectic honeycomb coordinates relative to rhombohedral origin and the region selector. */
+        __m512 xins = _mm512_sub_ps(xs16, xsbf);
+        __m512 yins = _mm512_sub_ps(ys16, ysbf);
+        __m512 zins = _mm512_sub_ps(zs16, zsbf);
+        __m512 inSum = _mm512_add_ps(_mm512_add_ps(xins, yins), zins);
+
+        __m512i key = classify3AVX512(xins, yins, zins, inSum);
+        __m512i region = _mm512_srli_epi32(key, 6);
+        __mmask16 upper = _mm512_cmpeq_epi32_mask(region, _mm512_set1_epi32(1));
+        __mmask16 middle = _mm512_cmpeq_epi32_mask(region, _mm512_set1_epi32(2));
+
+        /* The vertices of the region itself. Only the octahedron has more than four. */
+        int vertexCount = middle ? regionVertexCount3D[2] : regionVertexCount3D[0];
+        __m512 value = _mm512_setzero_ps();
+        for (int k = 0; k < vertexCount; k++) {
+            __m512i offsets = _mm512_mask_blend_epi32(middle, _mm512_mask_blend_epi32(upper, _mm512_set1_epi32(packOffsets(regionVertices3D[0][k])),
+                                                                                      _mm512_set1_epi32(packOffsets(regionVertices3D[1][k]))),
+                                                      _mm512_set1_epi32(packOffsets(regionVertices3D[2][k])));
+            __m512i lateOffsets = _mm512_mask_blend_epi32(middle, _mm512_mask_blend_epi32(upper, _mm512_set1_epi32(packLateOffsets(regionVertices3D[0][k])),
+                                                                                          _mm512_set1_epi32(packLateOffsets(regionVertices3D[1][k]))),
+                                                          _mm512_set1_epi32(packLateOffsets(regionVertices3D[2][k])));
+            value = contribution3AVX512(ctx, gradients, value, xsb, ysb, zsb, dx0, dy0, dz0, offsets, lateOffsets);
+        }
+
+        /* The two extra vertices. */
+        __m512i extra = _mm512_and_si512(_mm512_i32gather_epi32(key, (const void*) extraVertexIndex3D, 1), _mm512_set1_epi32(0xFF));
+        extra = _mm512_add_epi32(extra, extra);
+        for (int k = 0; k < 2; k++) {
+            __m512i index = _mm512_add_epi32(extra, _mm512_set1_epi32(k));
+            __m512i offsets = _mm512_i32gather_epi32(index, (const void*) extraVertices3D, 8);
+            __m512i lateOffsets = _mm512_i32gather_epi32(index, (const void*) ((const int*) extraVertices3D + 1), 8);
+            value = contribution3AVX512(ctx, gradients, value, xsb, ysb, zsb, dx0, dy0, dz0, offsets, lateOffsets);
+        }
+
+        _mm512_storeu_ps(out + i, _mm512_div_ps(value, normConstant));
+    }
+
+    noise3Scalar(ctx, xs + i, ys + i, zs + i, out + i, count - i);
+}
+
+template <typename ContextType>
+void NoiseBatch::noise4AVX512(const ContextType& ctx, const float* xs, const float* ys, const float* zs, const float* ws, float* out, size_t count)
+{
+    const __m512 stretchConstant = _mm512_set1_ps(-0.138196601125011f);
+    const __m512 squishConstant = _mm512_set1_ps(0.309016994374947f);
+    const __m512 normConstant = _mm512_set1_ps(30.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 x = _mm512_loadu_ps(xs + i);
+        __m512 y = _mm512_loadu_ps(ys + i);
+        __m512 z = _mm512_loadu_ps(zs + i);
+        __m512 w = _mm512_loadu_ps(ws + i);
+
+        /* Place input coordinates on simplectic honeycomb. */
+        __m512 stretchOffset = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_add_ps(x, y), z), w), stretchConstant);
+        __m512 xs16 = _mm512_add_ps(x, stretchOffset);
+        __m512 ys16 = _mm512_add_ps(y, stretchOffset);
+        __m512 zs16 = _mm512_add_ps(z, stretchOffset);
+        __m512 ws16 = _mm512_add_ps(w, stretchOffset);
+
+        /* Floor to get simplectic honeycomb coordinates of rhombo-hypercube super-cell origin. */
+        __m512i xsb = floorAVX512(xs16);
+        __m512i ysb = floorAVX512(ys16);
+        __m512i zsb = floorAVX512(zs16);
+        __m512i wsb = floorAVX512(ws16);
+        __m512 xsbf = _mm512_cvtepi32_ps(xsb);
+        __m512 ysbf = _mm512_cvtepi32_ps(ysb);
+        __m512 zsbf = _mm512_cvtepi32_ps(zsb);
+        __m512 wsbf = _mm512_cvtepi32_ps(wsb);
+
+        /* Skew out to get actual coordinates of stretched rhombo-hypercube origin. */
+        __m512 squishOffset = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_add_epi32(_mm512_add_epi32(xsb, ysb), zsb), wsb)), squishConstant);
+        __m512 dx0 = _mm512_sub_ps(x, _mm512_add_ps(xsbf, squishOffset));
+        __m512 dy0 = _mm512_sub_ps(y, _mm512_add_ps(ysbf, squishOffset));
+        __m512 dz0 = _mm512_sub_ps(z, _mm512_add_ps(zsbf, squishOffset));
+        __m512 dw0 = _mm512_sub_ps(w, _mm512_add_ps(wsbf, squishOffset));
+
+        /* Compute simplectic honeycomb coordinates relative to rhombo-hypercube origin and the region selector. */
+        __m512 xins = _mm512_sub_ps(xs16, xsbf);
+        __m512 yins = _mm512_sub_ps(ys16, ysbf);
+        __m512 zins = _mm512_sub_ps(zs16, zsbf);
+        __m512 wins = _mm512_sub_ps(ws16, wsbf);
+        __m512 inSum = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(xins, yins), zins), wins);
+
+        __m512i key = classify4AVX512(xins, yins, zins, wins, inSum);
+        __m512i region = _mm512_srli_epi32(key, 8);
+        __mmask16 region1 = _mm512_cmpeq_epi32_mask(region, _mm512_set1_epi32(1));
+        __mmask16 region2 = _mm512_cmpeq_epi32_mask(region, _mm512_set1_epi32(2));
+        __mmask16 region3 = _mm512_cmpeq_epi32_mask(region, _mm512_set1_epi32(3));
+
+        /* The vertices of the region itself. Only the dispentachora have more than five. */
+        int vertexCount = (region2 | region3) ? regionVertexCount4D[2] : regionVertexCount4D[0];
+        __m512 value = _mm512_setzero_ps();
+        for (int k = 0; k < vertexCount; k++) {
+            __m512i offsets = _mm512_set1_epi32(packOffsets(regionVertices4D[0][k]));
+            offsets = _mm512_mask_blend_epi32(region1, offsets, _mm512_set1_epi32(packOffsets(regionVertices4D[1][k])));
+            offsets = _mm512_mask_blend_epi32(region2, offsets, _mm512_set1_epi32(packOffsets(regionVertices4D[2][k])));
+            offsets = _mm512_mask_blend_epi32(region3, offsets, _mm512_set1_epi32(packOffsets(regionVertices4D[3][k])));
+            __m512i lateOffsets = _mm512_set1_epi32(packLateOffsets(regionVertices4D[0][k]));
+            lateOffsets = _mm512_mask_blend_epi32(region1, lateOffsets, _mm512_set1_epi32(packLateOffsets(regionVertices4D[1][k])));
+            lateOffsets = _mm512_mask_blend_epi32(region2, lateOffsets, _mm512_set1_epi32(packLateOffsets(regionVertices4D[2][k])));
+            lateOffsets = _mm512_mask_blend_epi32(region3, lateOffsets, _mm512_set1_epi32(packLateOffsets(regionVertices4D[3][k])));
+            value = contribution4AVX512(ctx, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, offsets, lateOffsets);
+        }
+
+        /* The three extra vertices. */
+        __m512i extra = _mm512_and_si512(_mm512_i32gather_epi32(key, (const void*) extraVertexIndex4D, 1), _mm512_set1_epi32(0xFF));
+        extra = _mm512_add_epi32(_mm512_add_epi32(extra, extra), extra);
+        for (int k = 0; k < 3; k++) {
+            __m512i index = _mm512_add_epi32(extra, _mm512_set1_epi32(k));
+            __m512i offsets = _mm512_i32gather_epi32(index, (const void*) extraVertices4D, 8);
+            __m512i lateOffsets = _mm512_i32gather_epi32(index, (const void*) ((const int*) extraVertices4D + 1), 8);
+            value = contribution4AVX512(ctx, value, xsb, ysb, zsb, wsb, dx0, dy0, dz0, dw0, offsets, lateOffsets);
+        }
+
+        _mm512_storeu_ps(out + i, _mm512_div_ps(value, normConstant));
+    }
+
+    noise4Scalar(ctx, xs + i, ys + i, zs + i, ws + i, out + i, count - i);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ == 12
+    #pragma GCC diagnostic pop
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC pop_options
+#endif
+
+#endif
+
+}
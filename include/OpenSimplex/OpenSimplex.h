@@ -33,8 +33,20 @@
 
 #include "Environment.h"
 #include "Context.h"
+#include "Gradients.h"
+#include "VertexTables.h"
 #include "Noise.h"
+#include "FixedNoise.h"
+#include "Fractal.h"
+#include "Warp.h"
 
 #if !OPENSIMPLEX_IS_GPU
 #include "Seed.h"
+#include "Dispatch.h"
+#include "NoiseBatch.h"
+#include "Quantize.h"
+#include "Slice.h"
+#include "AnimatedField.h"
+#include "StridedBatch.h"
+#include "VolumeSampler.h"
 #endif
@@ -0,0 +1,326 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "Quantize is a CPU API - on the GPU, write to a texture of the format you need instead!"
+#endif
+
+#include <cstddef>
+#include <cstring>
+
+#include "Context.h"
+#include "Noise.h"
+#include "NoiseBatch.h"
+
+namespace OpenSimplex
+{
+
+/* An IEEE 754 half precision value, as its bit pattern. */
+struct Half
+{
+    uint16_t bits;
+};
+
+/*
+ * The texel formats noise can be quantized to. uint8_t and uint16_t are
+ * unsigned normalized ([0, 1] over the whole integer range), int16_t is
+ * signed normalized ([-1, 1] over [-32767, 32767]) and Half is signed
+ * normalized in half precision.
+ */
+template <typename Out> struct QuantizeFormat;
+
+/*
+ * What the integer formats share: they can be dithered, and round to the
+ * nearest integer with halves away from zero, as lround does. The
+ * fraction x - (int) x is exact in float, so unlike adding 0.5 and
+ * truncating this never rounds the wrong way.
+ */
+struct IntegerQuantizeFormat
+{
+    static const bool canDither = true;
+
+    inline static int round(float x)
+    {
+        int whole = (int) x;
+        float fraction = x - whole;
+        return whole + (fraction >= 0.5f) - (fraction <= -0.5f);
+    }
+};
+
+template <>
+struct QuantizeFormat<uint8_t> : IntegerQuantizeFormat
+{
+    static const bool isSigned = false;
+    inline static float maximum() { return 255; }
+    inline static uint8_t convert(float x) { return (uint8_t) (x <= 0 ? 0 : x >= 255 ? 255 : round(x)); }
+};
+
+template <>
+struct QuantizeFormat<uint16_t> : IntegerQuantizeFormat
+{
+    static const bool isSigned = false;
+    inline static float maximum() { return 65535; }
+    inline static uint16_t convert(float x) { return (uint16_t) (x <= 0 ? 0 : x >= 65535 ? 65535 : round(x)); }
+};
+
+template <>
+struct QuantizeFormat<int16_t> : IntegerQuantizeFormat
+{
+    static const bool isSigned = true;
+    inline static float maximum() { return 32767; }
+    inline static int16_t convert(float x) { return (int16_t) (x <= -32767 ? -32767 : x >= 32767 ? 32767 : round(x)); }
+};
+
+template <>
+struct QuantizeFormat<Half>
+{
+    static const bool isSigned = true;
+    static const bool canDither = false;
+    inline static float maximum() { return 1; }
+    inline static Half convert(float x);
+};
+
+/*
+ * Rounds x, clamped to [-1, 1], to the nearest half. Below the normal range
+ * a float addition lines the mantissa up so that the FPU does the rounding.
+ */
+Half QuantizeFormat<Half>::convert(float x)
+{
+    x = x <= -1 ? -1 : x >= 1 ? 1 : x;
+
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    Half half;
+    if (bits < 0x38800000u) { /* Subnormal or zero. */
+        const uint32_t magicBits = 126u << 23;
+        float magic, value;
+        memcpy(&magic, &magicBits, sizeof(magic));
+        memcpy(&value, &bits, sizeof(value));
+        value += magic;
+        memcpy(&bits, &value, sizeof(bits));
+        half.bits = (uint16_t) (bits - magicBits);
+    } else { /* Normal, rounding the mantissa to nearest even. */
+        bits += (uint32_t) (15 - 127) << 23;
+        bits += 0xFFF + ((bits >> 13) & 1);
+        half.bits = (uint16_t) (bits >> 13);
+    }
+    half.bits |= (uint16_t) (sign >> 16);
+    return half;
+}
+
+/*
+ * Maps noise values linearly from [low, high] onto the normalized range of
+ * the format Out, clamping values outside it, and rounds them to the
+ * nearest representable value. With dither on, an ordered 4x4 Bayer
+ * pattern of offsets below one step is added before rounding integer
+ * formats, which breaks up banding in smooth gradients. An empty range
+ * (low == high) has no slope to map, so every value goes to the middle of
+ * the format's range.
+ */
+template <typename Out>
+class Quantizer
+{
+public:
+    inline explicit Quantizer(float low = -1, float high = 1, bool dither = false);
+
+    inline Out operator()(float value, int i, int j) const;
+
+private:
+    float scale, offset;
+    bool dither;
+};
+
+template <typename Out>
+Quantizer<Out>::Quantizer(float low, float high, bool dither)
+    : dither(dither && QuantizeFormat<Out>::canDither)
+{
+    float maximum = QuantizeFormat<Out>::maximum();
+    if (high == low) {
+        scale = 0;
+        offset = QuantizeFormat<Out>::isSigned ? 0 : maximum / 2;
+    } else if (QuantizeFormat<Out>::isSigned) {
+        scale = 2 * maximum / (high - low);
+        offset = -low * scale - maximum;
+    } else {
+        scale = maximum / (high - low);
+        offset = -low * scale;
+    }
+}
+
+/* Quantizes value, dithering as for the sample at (i, j) of a raster. */
+template <typename Out>
+Out Quantizer<Out>::operator()(float value, int i, int j) const
+{
+    static const int8_t bayer[16] = { 0, 8, 2, 10, 12, 4, 14, 6, 3, 11, 1, 9, 15, 7, 13, 5 };
+
+    float x = value * scale + offset;
+    if (dither)
+        x += (bayer[(j & 3) << 2 | (i & 3)] - 7.5f) * (1.0f / 16);
+    return QuantizeFormat<Out>::convert(x);
+}
+
+/*
+ * Noise written straight into integer or half precision buffers through a
+ * Quantizer. The raster functions quantize each sample as it comes out of
+ * the Noise::fillGrid2/3 tiles, with no float raster in between. The array
+ * functions run NoiseBatch over blocks small enough to stay in L1 and
+ * quantize each block as it is finished. Array elements are dithered as
+ * rows of four.
+ */
+class Quantize
+{
+public:
+    template <typename ContextType, typename Out>
+    inline static void noise2Batch(const ContextType& context, const float* xs, const float* ys, Out* out, size_t count,
+                                   const Quantizer<Out>& quantizer);
+    template <typename ContextType, typename Out>
+    inline static void noise3Batch(const ContextType& context, const float* xs, const float* ys, const float* zs, Out* out, size_t count,
+                                   const Quantizer<Out>& quantizer);
+    template <typename ContextType, typename Out>
+    inline static void noise4Batch(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, Out* out, size_t count,
+                                   const Quantizer<Out>& quantizer);
+
+    template <typename Out>
+    inline static void fillGrid2(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY,
+                                 float stepX, float stepY, int width, int height);
+    template <typename Out>
+    inline static void fillGrid3(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY, float originZ,
+                                 float stepX, float stepY, float stepZ, int width, int height, int depth);
+
+    template <typename Out>
+    inline static void fillGridRegion2(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY,
+                                       float stepX, float stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd);
+    template <typename Out>
+    inline static void fillGridRegion3(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY, float originZ,
+                                       float stepX, float stepY, float stepZ, int width, int height,
+                                       int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd);
+
+private:
+    static const size_t blockSize = 256;
+
+    template <typename Out>
+    struct Store
+    {
+        Out* out;
+        const Quantizer<Out>& quantizer;
+
+        inline Store(Out* out, const Quantizer<Out>& quantizer) : out(out), quantizer(quantizer) {}
+        inline void operator()(size_t index, int i, int j, float value) const { out[index] = quantizer(value, i, j); }
+    };
+
+    template <typename Out>
+    inline static void quantizeBlock(const float* values, Out* out, size_t begin, size_t count, const Quantizer<Out>& quantizer);
+};
+
+template <typename ContextType, typename Out>
+void Quantize::noise2Batch(const ContextType& context, const float* xs, const float* ys, Out* out, size_t count,
+                           const Quantizer<Out>& quantizer)
+{
+    float values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        NoiseBatch::noise2Batch(context, xs + begin, ys + begin, values, n);
+        quantizeBlock(values, out, begin, n, quantizer);
+    }
+}
+
+template <typename ContextType, typename Out>
+void Quantize::noise3Batch(const ContextType& context, const float* xs, const float* ys, const float* zs, Out* out, size_t count,
+                           const Quantizer<Out>& quantizer)
+{
+    float values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        NoiseBatch::noise3Batch(context, xs + begin, ys + begin, zs + begin, values, n);
+        quantizeBlock(values, out, begin, n, quantizer);
+    }
+}
+
+template <typename ContextType, typename Out>
+void Quantize::noise4Batch(const ContextType& context, const float* xs, const float* ys, const float* zs, const float* ws, Out* out, size_t count,
+                           const Quantizer<Out>& quantizer)
+{
+    float values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        NoiseBatch::noise4Batch(context, xs + begin, ys + begin, zs + begin, ws + begin, values, n);
+        quantizeBlock(values, out, begin, n, quantizer);
+    }
+}
+
+template <typename Out>
+void Quantize::fillGrid2(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY,
+                         float stepX, float stepY, int width, int height)
+{
+    fillGridRegion2(context, out, quantizer, originX, originY, stepX, stepY, width, 0, 0, width, height);
+}
+
+template <typename Out>
+void Quantize::fillGrid3(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY, float originZ,
+                         float stepX, float stepY, float stepZ, int width, int height, int depth)
+{
+    fillGridRegion3(context, out, quantizer, originX, originY, originZ, stepX, stepY, stepZ, width, height, 0, 0, 0, width, height, depth);
+}
+
+template <typename Out>
+void Quantize::fillGridRegion2(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY,
+                               float stepX, float stepY, int width, int iBegin, int jBegin, int iEnd, int jEnd)
+{
+    Noise::storeGridRegion2(context, Store<Out>(out, quantizer), originX, originY, stepX, stepY, width, iBegin, jBegin, iEnd, jEnd);
+}
+
+template <typename Out>
+void Quantize::fillGridRegion3(const Context& context, Out* out, const Quantizer<Out>& quantizer, float originX, float originY, float originZ,
+                               float stepX, float stepY, float stepZ, int width, int height,
+                               int iBegin, int jBegin, int kBegin, int iEnd, int jEnd, int kEnd)
+{
+    Noise::storeGridRegion3(context, Store<Out>(out, quantizer), originX, originY, originZ, stepX, stepY, stepZ, width, height,
+                            iBegin, jBegin, kBegin, iEnd, jEnd, kEnd);
+}
+
+/* Quantizes values into out[begin, begin + count). */
+template <typename Out>
+void Quantize::quantizeBlock(const float* values, Out* out, size_t begin, size_t count, const Quantizer<Out>& quantizer)
+{
+    for (size_t n = 0; n < count; n++) {
+        size_t index = begin + n;
+        out[index] = quantizer(values[n], (int) (index & 3), (int) (index >> 2 & 3));
+    }
+}
+
+}
@@ -45,6 +45,11 @@ namespace OpenSimplex
 namespace Seed
 {
     inline void computeContextForSeed(Context& context, int64_t seed);
+    OPENSIMPLEX_CONSTEXPR14 Context contextForSeed(int64_t seed);
+    inline void computeCompactContextForSeed(CompactContext& context, int64_t seed);
+    OPENSIMPLEX_CONSTEXPR14 CompactContext compact(const Context& context);
+    inline void computeHashContextForSeed(HashContext& context, int64_t seed);
+    OPENSIMPLEX_CONSTEXPR14 HashContext hashContextForSeed(int64_t seed);
 }
 
 /*
@@ -54,18 +59,42 @@ namespace Seed
  */
 void Seed::computeContextForSeed(OpenSimplex::Context& context, int64_t seed)
 {
-    int16_t source[256];
+    context = contextForSeed(seed);
+}
+
+/*
+ * Returns the context computeContextForSeed would fill in. From C++14 on
+ * this is constexpr, so a context for a fixed seed can be computed at
+ * compile time into read-only data:
+ *
+ *     static constexpr Context context = Seed::contextForSeed(42);
+ *
+ * The LCG runs on unsigned integers, which wrap where the signed arithmetic
+ * it replaces overflowed, and the signed remainder of the state is worked
+ * out explicitly, so both forms produce the same tables.
+ */
+OPENSIMPLEX_CONSTEXPR14 Context Seed::contextForSeed(int64_t seed)
+{
+    const uint64_t multiplier = 6364136223846793005ULL;
+    const uint64_t increment = 1442695040888963407ULL;
+
+    Context context = {};
+    int16_t source[256] = {};
 
     for (int i = 0; i < 256; i++)
         source[i] = (int16_t) i;
 
-    seed = seed * 6364136223846793005LL + 1442695040888963407LL;
-    seed = seed * 6364136223846793005LL + 1442695040888963407LL;
-    seed = seed * 6364136223846793005LL + 1442695040888963407LL;
+    uint64_t state = (uint64_t) seed;
+    state = state * multiplier + increment;
+    state = state * multiplier + increment;
+    state = state * multiplier + increment;
 
     for (int i = 255; i >= 0; i--) {
-        seed = seed * 6364136223846793005LL + 1442695040888963407LL;
-        int r = (int)((seed + 31) % (i + 1));
+        state = state * multiplier + increment;
+        uint64_t value = state + 31;
+        uint64_t count = (uint64_t) (i + 1);
+        /* The remainder of value read as a signed integer, which takes its sign. */
+        int r = (value >> 63) ? -(int)((~value + 1) % count) : (int)(value % count);
         if (r < 0)
             r += (i + 1);
         context.perm[i] = source[r];
@@ -73,6 +102,58 @@ void Seed::computeContextForSeed(OpenSimplex::Context& context, int64_t seed)
         context.permGradIndex3D[i] = (short)((context.perm[i] % (72 / 3)) * 3);
         source[r] = source[i];
     }
+
+    return context;
+}
+
+/*
+ * Initializes a CompactContext with the same permutation
+ * computeContextForSeed would produce, so noise evaluated through either
+ * gives the same values.
+ */
+void Seed::computeCompactContextForSeed(OpenSimplex::CompactContext& context, int64_t seed)
+{
+    context = compact(contextForSeed(seed));
+}
+
+/*
+ * Narrows the tables of a Context to bytes. Permutation entries are below
+ * 256 and 3D gradient indices below 72, so nothing is lost.
+ */
+OPENSIMPLEX_CONSTEXPR14 CompactContext Seed::compact(const Context& context)
+{
+    CompactContext narrow = {};
+
+    for (int i = 0; i < 256; i++) {
+        narrow.perm[i] = (uint8_t) context.perm[i];
+        narrow.permGradIndex3D[i] = (uint8_t) context.permGradIndex3D[i];
+    }
+
+    return narrow;
+}
+
+/*
+ * Initializes a HashContext from a 64-bit seed.
+ */
+void Seed::computeHashContextForSeed(OpenSimplex::HashContext& context, int64_t seed)
+{
+    context = hashContextForSeed(seed);
+}
+
+/*
+ * Returns the context computeHashContextForSeed would fill in. The seed is
+ * mixed down to 32 bits with the SplitMix64 finalizer, so that nearby seeds
+ * give unrelated noise.
+ */
+OPENSIMPLEX_CONSTEXPR14 HashContext Seed::hashContextForSeed(int64_t seed)
+{
+    uint64_t z = (uint64_t) seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    HashContext context = { (uint32_t) (z >> 32) };
+    return context;
 }
 
 }
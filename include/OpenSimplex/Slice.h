@@ -0,0 +1,200 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "Slice shouldn't be running on the GPU - so don't try including it!"
+#endif
+
+#include "Context.h"
+#include "Noise.h"
+#include "NoiseBatch.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * A plane of 3D noise at a fixed z, such as one frame of an animation. It
+ * is a convenience over NoiseBatch: rasters are streamed through
+ * NoiseBatch::noise3Batch a block of a row at a time, with z broadcast into
+ * a block on the stack. Nothing about the lattice is worked out once per
+ * plane, as the super-cell and region of a point depend on z and x and y
+ * together, so a raster costs the same as noise3Batch over its points. The
+ * values are those of NoiseBatch::noise3Batch (see there for when they are
+ * identical to Noise::noise3's).
+ *
+ * The slice keeps its own copy of the context, as AnimatedField does, so it
+ * can be built from a temporary. Slice3 takes a Context and HashSlice3 a
+ * HashContext.
+ */
+template <typename ContextType>
+class BasicSlice3
+{
+public:
+    static const int blockSize = 256;
+
+    inline BasicSlice3(const ContextType& context, float z);
+
+    inline float noise(float x, float y) const;
+    inline void fill(float* out, float originX, float originY, float stepX, float stepY, int width, int height) const;
+    inline void fillRegion(float* out, float originX, float originY, float stepX, float stepY,
+                           int width, int iBegin, int jBegin, int iEnd, int jEnd) const;
+
+private:
+    ContextType ctx;
+    float z;
+};
+
+/* A plane of 4D noise at a fixed z and w. See BasicSlice3. */
+template <typename ContextType>
+class BasicSlice4
+{
+public:
+    static const int blockSize = 256;
+
+    inline BasicSlice4(const ContextType& context, float z, float w);
+
+    inline float noise(float x, float y) const;
+    inline void fill(float* out, float originX, float originY, float stepX, float stepY, int width, int height) const;
+    inline void fillRegion(float* out, float originX, float originY, float stepX, float stepY,
+                           int width, int iBegin, int jBegin, int iEnd, int jEnd) const;
+
+private:
+    ContextType ctx;
+    float z, w;
+};
+
+typedef BasicSlice3<Context> Slice3;
+typedef BasicSlice3<HashContext> HashSlice3;
+typedef BasicSlice4<Context> Slice4;
+typedef BasicSlice4<HashContext> HashSlice4;
+
+template <typename ContextType>
+BasicSlice3<ContextType>::BasicSlice3(const ContextType& context, float z)
+    : ctx(context), z(z)
+{
+}
+
+/* 3D noise at (x, y) on the plane. */
+template <typename ContextType>
+float BasicSlice3<ContextType>::noise(float x, float y) const
+{
+    return Noise::noise3(ctx, x, y, z);
+}
+
+/*
+ * Fills out with a width x height raster, row by row, where
+ * out[j * width + i] is the noise at (originX + i * stepX, originY + j * stepY).
+ */
+template <typename ContextType>
+void BasicSlice3<ContextType>::fill(float* out, float originX, float originY, float stepX, float stepY, int width, int height) const
+{
+    fillRegion(out, originX, originY, stepX, stepY, width, 0, 0, width, height);
+}
+
+/*
+ * Fills only the samples [iBegin, iEnd) x [jBegin, jEnd) of the raster that
+ * fill would fill, so that threads can share one raster.
+ */
+template <typename ContextType>
+void BasicSlice3<ContextType>::fillRegion(float* out, float originX, float originY, float stepX, float stepY,
+                                          int width, int iBegin, int jBegin, int iEnd, int jEnd) const
+{
+    float xs[blockSize];
+    float ys[blockSize];
+    float zs[blockSize];
+
+    for (int i = 0; i < blockSize; i++)
+        zs[i] = z;
+    for (int i0 = iBegin; i0 < iEnd; i0 += blockSize) {
+        int count = iEnd - i0 < blockSize ? iEnd - i0 : blockSize;
+        for (int i = 0; i < count; i++)
+            xs[i] = originX + (i0 + i) * stepX;
+        for (int j = jBegin; j < jEnd; j++) {
+            float y = originY + j * stepY;
+            for (int i = 0; i < count; i++)
+                ys[i] = y;
+            NoiseBatch::noise3Batch(ctx, xs, ys, zs, out + (size_t) j * width + i0, count);
+        }
+    }
+}
+
+template <typename ContextType>
+BasicSlice4<ContextType>::BasicSlice4(const ContextType& context, float z, float w)
+    : ctx(context), z(z), w(w)
+{
+}
+
+/* 4D noise at (x, y) on the plane. */
+template <typename ContextType>
+float BasicSlice4<ContextType>::noise(float x, float y) const
+{
+    return Noise::noise4(ctx, x, y, z, w);
+}
+
+/* Fills a raster as BasicSlice3::fill does. */
+template <typename ContextType>
+void BasicSlice4<ContextType>::fill(float* out, float originX, float originY, float stepX, float stepY, int width, int height) const
+{
+    fillRegion(out, originX, originY, stepX, stepY, width, 0, 0, width, height);
+}
+
+/* Fills part of a raster as BasicSlice3::fillRegion does. */
+template <typename ContextType>
+void BasicSlice4<ContextType>::fillRegion(float* out, float originX, float originY, float stepX, float stepY,
+                                          int width, int iBegin, int jBegin, int iEnd, int jEnd) const
+{
+    float xs[blockSize];
+    float ys[blockSize];
+    float zs[blockSize];
+    float ws[blockSize];
+
+    for (int i = 0; i < blockSize; i++) {
+        zs[i] = z;
+        ws[i] = w;
+    }
+    for (int i0 = iBegin; i0 < iEnd; i0 += blockSize) {
+        int count = iEnd - i0 < blockSize ? iEnd - i0 : blockSize;
+        for (int i = 0; i < count; i++)
+            xs[i] = originX + (i0 + i) * stepX;
+        for (int j = jBegin; j < jEnd; j++) {
+            float y = originY + j * stepY;
+            for (int i = 0; i < count; i++)
+                ys[i] = y;
+            NoiseBatch::noise4Batch(ctx, xs, ys, zs, ws, out + (size_t) j * width + i0, count);
+        }
+    }
+}
+
+}
@@ -0,0 +1,145 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "StridedBatch shouldn't be running on the GPU - so don't try including it!"
+#endif
+
+#include <cstddef>
+
+#include "Context.h"
+#include "NoiseBatch.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * NoiseBatch for points stored with a stride, such as the positions inside
+ * an array of particle structs, rather than as separate coordinate arrays.
+ * The points are gathered a block at a time into coordinate arrays on the
+ * stack, run through NoiseBatch, and the results written back beside them.
+ * Nothing is allocated. It is only an adapter: points are evaluated in the
+ * order given, without binning them by cell, because the batch kernels
+ * cost the same whatever the order of their points.
+ *
+ * Point i has its coordinates at points[i * stride] onwards and its result
+ * goes to out[i * outStride]. With indices, only the points indices[0] to
+ * indices[count - 1] are evaluated, results again going to their own
+ * point's place in out. An index may appear more than once; its point is
+ * then evaluated again and the same value written again. The values are
+ * those of NoiseBatch.
+ */
+class StridedBatch
+{
+public:
+    static const size_t blockSize = 256;
+
+    template <typename ContextType>
+    inline static void noise2(const ContextType& context, const float* points, size_t stride, size_t count,
+                              float* out, size_t outStride = 1, const uint32_t* indices = 0);
+    template <typename ContextType>
+    inline static void noise3(const ContextType& context, const float* points, size_t stride, size_t count,
+                              float* out, size_t outStride = 1, const uint32_t* indices = 0);
+    template <typename ContextType>
+    inline static void noise4(const ContextType& context, const float* points, size_t stride, size_t count,
+                              float* out, size_t outStride = 1, const uint32_t* indices = 0);
+
+private:
+    inline static void gather(const float* points, size_t stride, size_t begin, size_t n, const uint32_t* indices,
+                              float* xs, float* ys, float* zs, float* ws);
+    inline static void scatter(const float* values, size_t begin, size_t n, const uint32_t* indices, float* out, size_t outStride);
+};
+
+template <typename ContextType>
+void StridedBatch::noise2(const ContextType& context, const float* points, size_t stride, size_t count,
+                          float* out, size_t outStride, const uint32_t* indices)
+{
+    float xs[blockSize], ys[blockSize], values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        gather(points, stride, begin, n, indices, xs, ys, 0, 0);
+        NoiseBatch::noise2Batch(context, xs, ys, values, n);
+        scatter(values, begin, n, indices, out, outStride);
+    }
+}
+
+template <typename ContextType>
+void StridedBatch::noise3(const ContextType& context, const float* points, size_t stride, size_t count,
+                          float* out, size_t outStride, const uint32_t* indices)
+{
+    float xs[blockSize], ys[blockSize], zs[blockSize], values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        gather(points, stride, begin, n, indices, xs, ys, zs, 0);
+        NoiseBatch::noise3Batch(context, xs, ys, zs, values, n);
+        scatter(values, begin, n, indices, out, outStride);
+    }
+}
+
+template <typename ContextType>
+void StridedBatch::noise4(const ContextType& context, const float* points, size_t stride, size_t count,
+                          float* out, size_t outStride, const uint32_t* indices)
+{
+    float xs[blockSize], ys[blockSize], zs[blockSize], ws[blockSize], values[blockSize];
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        gather(points, stride, begin, n, indices, xs, ys, zs, ws);
+        NoiseBatch::noise4Batch(context, xs, ys, zs, ws, values, n);
+        scatter(values, begin, n, indices, out, outStride);
+    }
+}
+
+/* Copies the coordinates of points [begin, begin + n) into xs, ys and, where not null, zs and ws. */
+void StridedBatch::gather(const float* points, size_t stride, size_t begin, size_t n, const uint32_t* indices,
+                          float* xs, float* ys, float* zs, float* ws)
+{
+    for (size_t k = 0; k < n; k++) {
+        const float* point = points + (indices ? indices[begin + k] : begin + k) * stride;
+        xs[k] = point[0];
+        ys[k] = point[1];
+        if (zs)
+            zs[k] = point[2];
+        if (ws)
+            ws[k] = point[3];
+    }
+}
+
+void StridedBatch::scatter(const float* values, size_t begin, size_t n, const uint32_t* indices, float* out, size_t outStride)
+{
+    for (size_t k = 0; k < n; k++)
+        out[(indices ? indices[begin + k] : begin + k) * outStride] = values[k];
+}
+
+}
@@ -0,0 +1,333 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "TileEngine shouldn't be running on the GPU - so don't try including it!"
+#endif
+
+/*
+ * Not included by OpenSimplex.h, since it needs the standard thread support
+ * (link with -pthread or Threads::Threads where required).
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Context.h"
+#include "Noise.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * Fills large rasters in parallel. The region is split into tiles small
+ * enough that a tile's output stays in cache, and the tiles are evaluated
+ * by a pool of worker threads that is created once and kept for the life of
+ * the engine. Each worker starts with an even share of the tiles and, once
+ * it runs out, steals half of the remaining tiles of another worker, so
+ * uneven tiles don't leave threads idle. The calling thread works too.
+ *
+ * The values written are identical to Noise::fillGrid2/3's. A Context is
+ * only read, so one can be shared by all workers. An engine runs one job at
+ * a time; don't call it from several threads at once. An exception thrown by
+ * a task, on any worker, cancels the tasks not yet started and is rethrown
+ * from parallelFor once every worker has stopped.
+ */
+class TileEngine
+{
+public:
+    inline explicit TileEngine(unsigned threadCount = 0);
+    inline ~TileEngine();
+
+    inline unsigned threadCount() const;
+
+    inline void fill2(const Context& context, float* out, float originX, float originY,
+                      float stepX, float stepY, int width, int height);
+    inline void fill3(const Context& context, float* out, float originX, float originY, float originZ,
+                      float stepX, float stepY, float stepZ, int width, int height, int depth);
+
+    template <typename Function> inline void parallelFor(int taskCount, const Function& function);
+
+private:
+    /* The tasks [begin, end) still waiting in one worker's queue. */
+    struct Queue
+    {
+        std::mutex mutex;
+        int begin;
+        int end;
+    };
+
+    TileEngine(const TileEngine&);
+    TileEngine& operator=(const TileEngine&);
+
+    inline void workerMain(unsigned worker);
+    inline void work(unsigned worker);
+    inline bool next(unsigned worker, int& task);
+
+    unsigned workerCount;
+    std::unique_ptr<Queue[]> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* job;
+    std::exception_ptr error;
+    std::atomic<bool> cancelled;
+    unsigned generation;
+    unsigned active;
+    bool stopping;
+};
+
+/*
+ * Starts threadCount - 1 worker threads, the caller being the last worker.
+ * By default there is one worker per hardware thread.
+ */
+TileEngine::TileEngine(unsigned threadCount)
+    : workerCount(threadCount), job(nullptr), cancelled(false), generation(0), active(0), stopping(false)
+{
+    if (workerCount == 0)
+        workerCount = std::thread::hardware_concurrency();
+    if (workerCount == 0)
+        workerCount = 1;
+
+    queues.reset(new Queue[workerCount]);
+    for (unsigned worker = 0; worker < workerCount; worker++)
+        queues[worker].begin = queues[worker].end = 0;
+
+    for (unsigned worker = 1; worker < workerCount; worker++)
+        threads.push_back(std::thread(&TileEngine::workerMain, this, worker));
+}
+
+TileEngine::~TileEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+unsigned TileEngine::threadCount() const
+{
+    return workerCount;
+}
+
+/*
+ * Fills out as Noise::fillGrid2 does, in tiles of 128 x 32 samples (16 KiB
+ * of output each).
+ */
+void TileEngine::fill2(const Context& context, float* out, float originX, float originY,
+                       float stepX, float stepY, int width, int height)
+{
+    const int tileWidth = 128;
+    const int tileHeight = 32;
+
+    int tilesX = (width + tileWidth - 1) / tileWidth;
+    int tilesY = (height + tileHeight - 1) / tileHeight;
+    parallelFor(tilesX * tilesY, [&](int tile) {
+        int i0 = (tile % tilesX) * tileWidth;
+        int j0 = (tile / tilesX) * tileHeight;
+        int i1 = i0 + tileWidth < width ? i0 + tileWidth : width;
+        int j1 = j0 + tileHeight < height ? j0 + tileHeight : height;
+        Noise::fillGridRegion2(context, out, originX, originY, stepX, stepY, width, i0, j0, i1, j1);
+    });
+}
+
+/*
+ * Fills out as Noise::fillGrid3 does, in tiles of 64 x 16 x 4 samples (16 KiB
+ * of output each).
+ */
+void TileEngine::fill3(const Context& context, float* out, float originX, float originY, float originZ,
+                       float stepX, float stepY, float stepZ, int width, int height, int depth)
+{
+    const int tileWidth = 64;
+    const int tileHeight = 16;
+    const int tileDepth = 4;
+
+    int tilesX = (width + tileWidth - 1) / tileWidth;
+    int tilesY = (height + tileHeight - 1) / tileHeight;
+    int tilesZ = (depth + tileDepth - 1) / tileDepth;
+    parallelFor(tilesX * tilesY * tilesZ, [&](int tile) {
+        int i0 = (tile % tilesX) * tileWidth;
+        int j0 = (tile / tilesX % tilesY) * tileHeight;
+        int k0 = (tile / tilesX / tilesY) * tileDepth;
+        int i1 = i0 + tileWidth < width ? i0 + tileWidth : width;
+        int j1 = j0 + tileHeight < height ? j0 + tileHeight : height;
+        int k1 = k0 + tileDepth < depth ? k0 + tileDepth : depth;
+        Noise::fillGridRegion3(context, out, originX, originY, originZ, stepX, stepY, stepZ,
+                               width, height, i0, j0, k0, i1, j1, k1);
+    });
+}
+
+/*
+ * Calls function(task) for every task in [0, taskCount) across the workers,
+ * returning once all calls have returned. If a call throws, the first
+ * exception thrown is rethrown here after the workers have stopped, and some
+ * tasks may not have been run.
+ */
+template <typename Function>
+void TileEngine::parallelFor(int taskCount, const Function& function)
+{
+    if (taskCount <= 0)
+        return;
+
+    if (workerCount == 1) {
+        for (int task = 0; task < taskCount; task++)
+            function(task);
+        return;
+    }
+
+    for (unsigned worker = 0; worker < workerCount; worker++) {
+        std::lock_guard<std::mutex> lock(queues[worker].mutex);
+        queues[worker].begin = (int)((long long) taskCount * worker / workerCount);
+        queues[worker].end = (int)((long long) taskCount * (worker + 1) / workerCount);
+    }
+
+    std::function<void(int)> wrapped(std::cref(function));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &wrapped;
+        error = nullptr;
+        cancelled = false;
+        active = workerCount;
+        generation++;
+    }
+    wake.notify_all();
+
+    work(0);
+
+    std::exception_ptr thrown;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        active--;
+        done.wait(lock, [this] { return active == 0; });
+        job = nullptr;
+        thrown = error;
+        error = nullptr;
+    }
+    if (thrown)
+        std::rethrow_exception(thrown);
+}
+
+void TileEngine::workerMain(unsigned worker)
+{
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        work(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--active == 0)
+            done.notify_one();
+    }
+}
+
+/*
+ * Runs tasks until there are none left to take or steal, or a task has
+ * thrown. Exceptions are kept for parallelFor rather than let out of the
+ * worker, where they would end the program.
+ */
+void TileEngine::work(unsigned worker)
+{
+    const std::function<void(int)>& function = *job;
+    int task;
+    while (!cancelled && next(worker, task)) {
+        try {
+            function(task);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            cancelled = true;
+        }
+    }
+}
+
+/*
+ * Takes the next task from the front of the worker's own queue or, if that
+ * is empty, steals the back half of the first non-empty queue after it.
+ */
+bool TileEngine::next(unsigned worker, int& task)
+{
+    Queue& own = queues[worker];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.begin < own.end) {
+            task = own.begin++;
+            return true;
+        }
+    }
+
+    for (unsigned i = 1; i < workerCount; i++) {
+        Queue& victim = queues[(worker + i) % workerCount];
+        int begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            int remaining = victim.end - victim.begin;
+            if (remaining <= 0)
+                continue;
+            end = victim.end;
+            begin = victim.end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock(own.mutex);
+        task = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,466 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * A lattice vertex visited by noise3 or noise4, as an offset from the
+ * super-cell origin (xsb, ysb, zsb, wsb). Along each axis its displacement
+ * from the input point is
+ *
+ *     ((d0 - (offset - late)) - (sum of offsets) * squishConstant) - late
+ *
+ * which is the expression the scalar functions evaluate. Most vertices have
+ * no late part; the few that the scalar code reaches by adjusting another
+ * displacement after its squish term (e.g. "dy_ext1 -= 1") keep that step
+ * separate so the result rounds identically.
+ */
+struct LatticeVertex
+{
+    int8_t x, y, z, w;
+    int8_t lateX, lateY, lateZ, lateW;
+};
+
+/*
+ * The vertex selection of noise3 and noise4 as tables, so that it can be
+ * done with a lookup rather than a branch tree.
+ *
+ * Regions are numbered in the order the scalar functions test them: the
+ * simplex at the origin, the simplex at the far corner, then the one (3D)
+ * or two (4D) rectified simplices in between. Each region contributes its
+ * own vertices in a fixed order, padded with a vertex too far away to ever
+ * contribute, followed by two (3D) or three (4D) extra vertices. The extra
+ * vertices depend on which region vertices are closest, and are looked up
+ * through extraVertexIndex with the key
+ *
+ *     3D: region << 6 | (c | c1) << 3 | c2
+ *     4D: region << 8 | (c | c1) << 4 | c2
+ *
+ * where c, c1 and c2 are the vertex masks the scalar code derives from
+ * aPoint and bPoint (0 when a branch doesn't use them). The index tables
+ * are sized so that a 32-bit gather at any key stays in bounds.
+ */
+OPENSIMPLEX_GPU_CONSTANT const LatticeVertex regionVertices3D[3][6] = {
+    {
+        {  0,  0,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  0,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  0,  0, 0, 0, 0 },
+        {  0,  0,  1,  0,  0, 0, 0, 0 },
+        {  4,  4,  4,  0,  0, 0, 0, 0 },
+        {  4,  4,  4,  0,  0, 0, 0, 0 },
+    },
+    {
+        {  1,  1,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  1,  0,  0, 0, 0, 0 },
+        {  0,  1,  1,  0,  0, 0, 0, 0 },
+        {  1,  1,  1,  0,  0, 0, 0, 0 },
+        {  4,  4,  4,  0,  0, 0, 0, 0 },
+        {  4,  4,  4,  0,  0, 0, 0, 0 },
+    },
+    {
+        {  1,  0,  0,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  0,  0, 0, 0, 0 },
+        {  0,  0,  1,  0,  0, 0, 0, 0 },
+        {  1,  1,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  1,  0,  0, 0, 0, 0 },
+        {  0,  1,  1,  0,  0, 0, 0, 0 },
+    },
+};
+
+OPENSIMPLEX_GPU_CONSTANT const uint8_t regionVertexCount3D[3] = { 4, 4, 6 };
+
+OPENSIMPLEX_GPU_CONSTANT const uint8_t extraVertexIndex3D[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     1,  0,  0,  0,  0,  0,  0,  0,  2,  0,  0,  0,  0,  0,  0,  0,
+     3,  0,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,
+     5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  6,  0,  0,  0,  0,  0,  0,  0,
+     7,  0,  0,  0,  0,  0,  0,  0,  8,  0,  0,  0,  0,  0,  0,  0,
+     9,  0,  0,  0,  0,  0,  0,  0, 10,  0,  0,  0,  0,  0,  0,  0,
+    11,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0, 12,  0,  0,  0,  0,  0,  0,  0,
+    13,  0,  0,  0,  0,  0,  0,  0, 14, 15, 16,  0,  0,  0,  0,  0,
+    17,  0,  0,  0,  0,  0,  0,  0, 18, 19,  0,  0, 20,  0,  0,  0,
+    21,  0, 22,  0, 23,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+OPENSIMPLEX_GPU_CONSTANT const LatticeVertex extraVertices3D[24][2] = {
+    { {  1, -1,  0,  0,  0, 0, 0, 0 }, {  1,  0, -1,  0,  0, 0, 0, 0 } },
+    { { -1,  1,  0,  0,  0, 0, 0, 0 }, {  0,  1, -1,  0,  0, 0, 0, 0 } },
+    { {  1,  1,  0,  0,  0, 0, 0, 0 }, {  1,  1, -1,  0,  0, 0, 0, 0 } },
+    { { -1,  0,  1,  0,  0, 0, 0, 0 }, {  0, -1,  1,  0,  0, 0, 0, 0 } },
+    { {  1,  0,  1,  0,  0, 0, 0, 0 }, {  1, -1,  1,  0,  0, 0, 0, 0 } },
+    { {  0,  1,  1,  0,  0, 0, 0, 0 }, { -1,  1,  1,  0,  0, 0, 0, 0 } },
+    { {  1,  0,  0,  0,  0, 0, 0, 0 }, {  2,  0,  0,  0,  0, 0, 0, 0 } },
+    { {  0,  1,  0,  0,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 0, 0, 0 } },
+    { {  2,  1,  0,  0,  0, 0, 0, 0 }, {  1,  2,  0,  0,  0, 1, 0, 0 } },
+    { {  0,  0,  1,  0,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 0, 0 } },
+    { {  2,  0,  1,  0,  0, 0, 0, 0 }, {  1,  0,  2,  0,  0, 0, 0, 0 } },
+    { {  0,  2,  1,  0,  0, 1, 0, 0 }, {  0,  1,  2,  0,  0, 0, 0, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  2,  0,  0,  0,  0, 0, 0, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 0, 0, 0 } },
+    { {  0,  0,  0,  0,  0, 0, 0, 0 }, {  1,  1, -1,  0,  0, 0, 0, 0 } },
+    { {  1,  1, -1,  0,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1,  1, -1,  0,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 0, 0 } },
+    { {  0,  0,  0,  0,  0, 0, 0, 0 }, {  1, -1,  1,  0,  0, 0, 0, 0 } },
+    { {  1, -1,  1,  0,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1, -1,  1,  0,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { {  0,  0,  0,  0,  0, 0, 0, 0 }, { -1,  1,  1,  0,  0, 0, 0, 0 } },
+    { { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+};
+
+OPENSIMPLEX_GPU_CONSTANT const LatticeVertex regionVertices4D[4][10] = {
+    {
+        {  0,  0,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  0,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  0,  0, 0, 0, 0 },
+        {  0,  0,  1,  0,  0, 0, 0, 0 },
+        {  0,  0,  0,  1,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+    },
+    {
+        {  1,  1,  1,  0,  0, 0, 0, 0 },
+        {  1,  1,  0,  1,  0, 0, 0, 0 },
+        {  1,  0,  1,  1,  0, 0, 0, 0 },
+        {  0,  1,  1,  1,  0, 0, 0, 0 },
+        {  1,  1,  1,  1,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+        {  4,  4,  4,  4,  0, 0, 0, 0 },
+    },
+    {
+        {  1,  0,  0,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  0,  0, 0, 0, 0 },
+        {  0,  0,  1,  0,  0, 0, 0, 0 },
+        {  0,  0,  0,  1,  0, 0, 0, 0 },
+        {  1,  1,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  1,  0,  0, 0, 0, 0 },
+        {  1,  0,  0,  1,  0, 0, 0, 0 },
+        {  0,  1,  1,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  1,  0, 0, 0, 0 },
+        {  0,  0,  1,  1,  0, 0, 0, 0 },
+    },
+    {
+        {  1,  1,  1,  0,  0, 0, 0, 0 },
+        {  1,  1,  0,  1,  0, 0, 0, 0 },
+        {  1,  0,  1,  1,  0, 0, 0, 0 },
+        {  0,  1,  1,  1,  0, 0, 0, 0 },
+        {  1,  1,  0,  0,  0, 0, 0, 0 },
+        {  1,  0,  1,  0,  0, 0, 0, 0 },
+        {  1,  0,  0,  1,  0, 0, 0, 0 },
+        {  0,  1,  1,  0,  0, 0, 0, 0 },
+        {  0,  1,  0,  1,  0, 0, 0, 0 },
+        {  0,  0,  1,  1,  0, 0, 0, 0 },
+    },
+};
+
+OPENSIMPLEX_GPU_CONSTANT const uint8_t regionVertexCount4D[4] = { 5, 5, 10, 10 };
+
+OPENSIMPLEX_GPU_CONSTANT const uint8_t extraVertexIndex4D[1024] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     1,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     2,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     3,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     4,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     6,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     7,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     8,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     9,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    10,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    11,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    12,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    13,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    14,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    15,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    16,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    17,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    18,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    19,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    20, 21, 22,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    23, 24,  0,  0, 25,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    26,  0, 27,  0, 28,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0, 29, 30,  0, 31,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    32, 33,  0,  0,  0,  0,  0,  0, 34,  0,  0,  0,  0,  0,  0,  0,
+    35,  0, 36,  0,  0,  0,  0,  0, 37,  0,  0,  0,  0,  0,  0,  0,
+     0, 38, 39,  0,  0,  0,  0,  0, 40,  0,  0,  0,  0,  0,  0,  0,
+    41,  0,  0,  0, 42,  0,  0,  0, 43,  0,  0,  0,  0,  0,  0,  0,
+     0, 44,  0,  0, 45,  0,  0,  0, 46,  0,  0,  0,  0,  0,  0,  0,
+     0,  0, 47,  0, 48,  0,  0,  0, 49,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0, 50,  0,  0,  0, 51,  0, 52,  0,  0,
+     0,  0,  0,  0,  0,  0,  0, 53,  0,  0,  0, 54,  0,  0, 55,  0,
+    56,  0,  0,  0,  0,  0,  0, 57,  0,  0,  0, 58,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0, 59,  0,  0,  0,  0,  0, 60, 61,  0,
+    62,  0,  0,  0,  0,  0,  0, 63,  0,  0,  0,  0,  0, 64,  0,  0,
+    65,  0,  0,  0,  0,  0,  0, 66,  0,  0,  0,  0,  0,  0, 67,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 68,  0, 69, 70,  0,
+    71,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 72,  0, 73,  0,  0,
+    74,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 75,  0,  0, 76,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    77,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 78, 79,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+OPENSIMPLEX_GPU_CONSTANT const LatticeVertex extraVertices4D[80][3] = {
+    { {  1, -1,  0,  0,  0, 0, 0, 0 }, {  1,  0, -1,  0,  0, 0, 0, 0 }, {  1,  0,  0, -1,  0, 0, 0, 0 } },
+    { { -1,  1,  0,  0,  0, 0, 0, 0 }, {  0,  1, -1,  0,  0, 0, 0, 0 }, {  0,  1,  0, -1,  0, 0, 0, 0 } },
+    { {  1,  1,  0,  0,  0, 0, 0, 0 }, {  1,  1, -1,  0,  0, 0, -1, 0 }, {  1,  1,  0, -1,  0, 0, 0, 0 } },
+    { { -1,  0,  1,  0,  0, 0, 0, 0 }, {  0, -1,  1,  0,  0, 0, 0, 0 }, {  0,  0,  1, -1,  0, 0, 0, 0 } },
+    { {  1,  0,  1,  0,  0, 0, 0, 0 }, {  1, -1,  1,  0,  0, -1, 0, 0 }, {  1,  0,  1, -1,  0, 0, 0, 0 } },
+    { {  0,  1,  1,  0,  0, 0, 0, 0 }, { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  1,  1, -1,  0, 0, 0, 0 } },
+    { { -1,  0,  0,  1,  0, 0, 0, 0 }, {  0, -1,  0,  1,  0, 0, 0, 0 }, {  0,  0, -1,  1,  0, 0, 0, 0 } },
+    { {  1,  0,  0,  1,  0, 0, 0, 0 }, {  1, -1,  0,  1,  0, -1, 0, 0 }, {  1,  0, -1,  1,  0, 0, -1, 0 } },
+    { {  0,  1,  0,  1,  0, 0, 0, 0 }, { -1,  1,  0,  1,  0, 0, 0, 0 }, {  0,  1, -1,  1,  0, 0, -1, 0 } },
+    { {  0,  0,  1,  1,  0, 0, 0, 0 }, { -1,  0,  1,  1,  0, 0, 0, 0 }, {  0, -1,  1,  1,  0, -1, 0, 0 } },
+    { {  1,  1,  0,  0,  0, 0, 0, 0 }, {  2,  1,  0,  0,  0, 0, 0, 0 }, {  1,  2,  0,  0,  0, 1, 0, 0 } },
+    { {  1,  0,  1,  0,  0, 0, 0, 0 }, {  2,  0,  1,  0,  0, 0, 0, 0 }, {  1,  0,  2,  0,  0, 0, 1, 0 } },
+    { {  0,  1,  1,  0,  0, 0, 0, 0 }, {  0,  2,  1,  0,  0, 1, 0, 0 }, {  0,  1,  2,  0,  0, 0, 1, 0 } },
+    { {  2,  1,  1,  0,  0, 0, 0, 0 }, {  1,  2,  1,  0,  0, 1, 0, 0 }, {  1,  1,  2,  0,  0, 0, 1, 0 } },
+    { {  1,  0,  0,  1,  0, 0, 0, 0 }, {  2,  0,  0,  1,  0, 0, 0, 0 }, {  1,  0,  0,  2,  0, 0, 0, 0 } },
+    { {  0,  1,  0,  1,  0, 0, 0, 0 }, {  0,  2,  0,  1,  0, 1, 0, 0 }, {  0,  1,  0,  2,  0, 0, 0, 0 } },
+    { {  2,  1,  0,  1,  0, 0, 0, 0 }, {  1,  2,  0,  1,  0, 1, 0, 0 }, {  1,  1,  0,  2,  0, 0, 0, 0 } },
+    { {  0,  0,  1,  1,  0, 0, 0, 0 }, {  0,  0,  2,  1,  0, 0, 1, 0 }, {  0,  0,  1,  2,  0, 0, 0, 0 } },
+    { {  2,  0,  1,  1,  0, 0, 0, 0 }, {  1,  0,  2,  1,  0, 0, 1, 0 }, {  1,  0,  1,  2,  0, 0, 0, 0 } },
+    { {  0,  2,  1,  1,  0, 1, 0, 0 }, {  0,  1,  2,  1,  0, 0, 1, 0 }, {  0,  1,  1,  2,  0, 0, 0, 0 } },
+    { {  1,  1, -1,  0,  0, 0, -1, 0 }, {  1,  1,  0, -1,  0, 0, 0, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { {  1,  1, -1,  0,  0, 0, -1, 0 }, {  1,  1,  0, -1,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1,  1, -1,  0,  0, 0, -1, 0 }, {  1,  1,  0, -1,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { {  1, -1,  1,  0,  0, -1, 0, 0 }, {  1,  0,  1, -1,  0, 0, 0, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { {  1, -1,  1,  0,  0, -1, 0, 0 }, {  1,  0,  1, -1,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1, -1,  1,  0,  0, -1, 0, 0 }, {  1,  0,  1, -1,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  1,  1, -1,  0, 0, 0, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  1,  1, -1,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { { -1,  1,  1,  0,  0, 0, 0, 0 }, {  0,  1,  1, -1,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { {  1,  1,  1,  0,  0, 0, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { {  1, -1,  0,  1,  0, -1, 0, 0 }, {  1,  0, -1,  1,  0, 0, -1, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { {  1, -1,  0,  1,  0, -1, 0, 0 }, {  1,  0, -1,  1,  0, 0, -1, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1, -1,  0,  1,  0, -1, 0, 0 }, {  1,  0, -1,  1,  0, 0, -1, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { { -1,  1,  0,  1,  0, 0, 0, 0 }, {  0,  1, -1,  1,  0, 0, -1, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { { -1,  1,  0,  1,  0, 0, 0, 0 }, {  0,  1, -1,  1,  0, 0, -1, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { { -1,  1,  0,  1,  0, 0, 0, 0 }, {  0,  1, -1,  1,  0, 0, -1, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { {  1,  1,  0,  1,  0, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1,  1,  0,  1,  0, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { {  1,  1,  0,  1,  0, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, 0, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { { -1,  0,  1,  1,  0, 0, 0, 0 }, {  0, -1,  1,  1,  0, -1, 0, 0 }, {  0,  0,  0,  0,  0, 0, 0, 0 } },
+    { { -1,  0,  1,  1,  0, 0, 0, 0 }, {  0, -1,  1,  1,  0, -1, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { { -1,  0,  1,  1,  0, 0, 0, 0 }, {  0, -1,  1,  1,  0, -1, 0, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { {  1,  0,  1,  1,  0, 0, 0, 0 }, {  1, -1,  1,  1,  0, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 } },
+    { {  1,  0,  1,  1,  0, 0, 0, 0 }, {  1, -1,  1,  1,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { {  1,  0,  1,  1,  0, 0, 0, 0 }, {  1, -1,  1,  1,  0, 0, 0, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { {  0,  1,  1,  1,  0, 0, 0, 0 }, { -1,  1,  1,  1,  0, 0, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 } },
+    { {  0,  1,  1,  1,  0, 0, 0, 0 }, { -1,  1,  1,  1,  0, 0, 0, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 } },
+    { {  0,  1,  1,  1,  0, 0, 0, 0 }, { -1,  1,  1,  1,  0, 0, 0, 0 }, {  0,  0,  0,  2,  0, 0, 0, 2 } },
+    { {  1,  0,  0,  0,  1, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  1,  0,  0,  0,  1, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  1,  0,  0,  0,  1, 0, 0, 0 }, {  2,  0,  0,  0,  2, 0, 0, 0 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  1,  0,  0,  0, 1, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  0,  1,  0,  0,  0, 1, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  0,  1,  0,  0,  0, 1, 0, 0 }, {  0,  2,  0,  0,  0, 2, 0, 0 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+    { {  2,  1,  0,  0,  0, 0, 0, 0 }, {  1,  2,  0,  0,  0, 1, 0, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  2,  1,  0,  0,  0, 0, 0, 0 }, {  1,  2,  0,  0,  0, 1, 0, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  2,  1,  0,  0,  0, 0, 0, 0 }, {  1,  2,  0,  0,  0, 1, 0, 0 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  0,  0,  1,  0,  0, 0, 1, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  0,  0,  1,  0,  0, 0, 1, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  0,  1,  0,  0, 0, 1, 0 }, {  0,  0,  2,  0,  0, 0, 2, 0 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+    { {  2,  0,  1,  0,  0, 0, 0, 0 }, {  1,  0,  2,  0,  0, 0, 1, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  2,  0,  1,  0,  0, 0, 0, 0 }, {  1,  0,  2,  0,  0, 0, 1, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  2,  0,  1,  0,  0, 0, 0, 0 }, {  1,  0,  2,  0,  0, 0, 1, 0 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  2,  1,  0,  0, 1, 0, 0 }, {  0,  1,  2,  0,  0, 0, 1, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  0,  2,  1,  0,  0, 1, 0, 0 }, {  0,  1,  2,  0,  0, 0, 1, 0 }, {  1,  1,  1, -1,  0, 0, 0, -2 } },
+    { {  0,  2,  1,  0,  0, 1, 0, 0 }, {  0,  1,  2,  0,  0, 0, 1, 0 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+    { {  0,  0,  0,  1,  0, 0, 0, 1 }, {  0,  0,  0,  2,  0, 0, 0, 2 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  0,  0,  0,  1,  0, 0, 0, 1 }, {  0,  0,  0,  2,  0, 0, 0, 2 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  0,  0,  1,  0, 0, 0, 1 }, {  0,  0,  0,  2,  0, 0, 0, 2 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+    { {  2,  0,  0,  1,  0, 0, 0, 0 }, {  1,  0,  0,  2,  0, 0, 0, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  2,  0,  0,  1,  0, 0, 0, 0 }, {  1,  0,  0,  2,  0, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  2,  0,  0,  1,  0, 0, 0, 0 }, {  1,  0,  0,  2,  0, 0, 0, 0 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  2,  0,  1,  0, 1, 0, 0 }, {  0,  1,  0,  2,  0, 0, 0, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  0,  2,  0,  1,  0, 1, 0, 0 }, {  0,  1,  0,  2,  0, 0, 0, 0 }, {  1,  1, -1,  1,  0, 0, -2, 0 } },
+    { {  0,  2,  0,  1,  0, 1, 0, 0 }, {  0,  1,  0,  2,  0, 0, 0, 0 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+    { {  0,  0,  2,  1,  0, 0, 1, 0 }, {  0,  0,  1,  2,  0, 0, 0, 0 }, {  1,  1,  1,  1,  0, 0, 0, 0 } },
+    { {  0,  0,  2,  1,  0, 0, 1, 0 }, {  0,  0,  1,  2,  0, 0, 0, 0 }, {  1, -1,  1,  1,  0, -2, 0, 0 } },
+    { {  0,  0,  2,  1,  0, 0, 1, 0 }, {  0,  0,  1,  2,  0, 0, 0, 0 }, { -1,  1,  1,  1,  -2, 0, 0, 0 } },
+};
+
+/*
+ * Selects the region and extra vertices of a point with comparisons and
+ * selects rather than branches, for noise3Table, noise4Table and
+ * FixedNoise. Scores may be of any arithmetic type S, in units where a step
+ * along the lattice is one: 1 in floating point, or a fixed point one.
+ */
+class RegionClassifier
+{
+public:
+    template <typename S> inline static int classify3(S xins, S yins, S zins, S inSum, S one);
+    template <typename S> inline static void closestGreater(S& aScore, int& aPoint, S& bScore, int& bPoint, S score, int point);
+    template <typename S> inline static void closestSmaller(S& aScore, int& aPoint, S& bScore, int& bPoint, S score, int point);
+};
+
+/*
+ * The region noise3 would take for a point and the vertices it would find
+ * closest, as the extraVertexIndex3D key described above. All three regions
+ * are classified and the right key selected, so there is nothing to
+ * mispredict.
+ */
+template <typename S>
+int RegionClassifier::classify3(S xins, S yins, S zins, S inSum, S one)
+{
+    const int further = 0x08; /* Marks a point on the further side, above the 3-bit vertex mask. */
+
+    /* Tetrahedron at (0,0,0): which two of (0,0,1), (0,1,0), (1,0,0) are closest. */
+    S aScore = xins;
+    S bScore = yins;
+    int aPoint = 0x01;
+    int bPoint = 0x02;
+    closestGreater(aScore, aPoint, bScore, bPoint, zins, 0x04);
+
+    S wins = one - inSum;
+    bool near = (wins > aScore) | (wins > bScore);
+    int closest = bScore > aScore ? bPoint : aPoint;
+    int keyLower = (near ? closest : aPoint | bPoint) << 3;
+
+    /* Tetrahedron at (1,1,1): which two of (1,1,0), (1,0,1), (0,1,1) are closest. */
+    aScore = xins;
+    bScore = yins;
+    aPoint = 0x06;
+    bPoint = 0x05;
+    closestSmaller(aScore, aPoint, bScore, bPoint, zins, 0x03);
+
+    wins = 3 * one - inSum;
+    near = (wins < aScore) | (wins < bScore);
+    closest = bScore < aScore ? bPoint : aPoint;
+    int keyUpper = 1 << 6 | (near ? closest : aPoint & bPoint) << 3;
+
+    /* Octahedron: the closest two of its six vertices, found through the three opposite pairs. */
+    S p1 = xins + yins;
+    bool p1Further = p1 > one;
+    aScore = p1Further ? p1 - one : one - p1;
+    aPoint = p1Further ? 0x03 | further : 0x04;
+
+    S p2 = xins + zins;
+    bool p2Further = p2 > one;
+    bScore = p2Further ? p2 - one : one - p2;
+    bPoint = p2Further ? 0x05 | further : 0x02;
+
+    S p3 = yins + zins;
+    bool p3Further = p3 > one;
+    S score = p3Further ? p3 - one : one - p3;
+    int point = p3Further ? 0x06 | further : 0x01;
+
+    /* Unlike the tetrahedra, ties here replace a rather than b. */
+    bool replaceA = (aScore <= bScore) & (aScore < score);
+    bool replaceB = (aScore > bScore) & (bScore < score);
+    aPoint = replaceA ? point : aPoint;
+    bPoint = replaceB ? point : bPoint;
+
+    bool aFurther = (aPoint & further) != 0;
+    bool sameSide = (aPoint & further) == (bPoint & further);
+    aPoint &= ~further;
+    bPoint &= ~further;
+
+    int keySame = (aFurther ? aPoint & bPoint : aPoint | bPoint) << 3;
+    int keyMixed = aFurther ? aPoint << 3 | bPoint : bPoint << 3 | aPoint;
+    int keyMiddle = 2 << 6 | (sameSide ? keySame : keyMixed);
+
+    return inSum <= one ? keyLower : inSum >= 2 * one ? keyUpper : keyMiddle;
+}
+
+/*
+ * Offers point with score to the closest pair (a, b), replacing the one
+ * noise3 and noise4 would when looking for the highest scores.
+ */
+template <typename S>
+void RegionClassifier::closestGreater(S& aScore, int& aPoint, S& bScore, int& bPoint, S score, int point)
+{
+    bool replaceB = (aScore >= bScore) & (score > bScore);
+    bool replaceA = (aScore < bScore) & (score > aScore);
+    bScore = replaceB ? score : bScore;
+    bPoint = replaceB ? point : bPoint;
+    aScore = replaceA ? score : aScore;
+    aPoint = replaceA ? point : aPoint;
+}
+
+/*
+ * As closestGreater, but looking for the lowest scores.
+ */
+template <typename S>
+void RegionClassifier::closestSmaller(S& aScore, int& aPoint, S& bScore, int& bPoint, S score, int point)
+{
+    bool replaceB = (aScore <= bScore) & (score < bScore);
+    bool replaceA = (aScore > bScore) & (score < aScore);
+    bScore = replaceB ? score : bScore;
+    bPoint = replaceB ? point : bPoint;
+    aScore = replaceA ? score : aScore;
+    aPoint = replaceA ? point : aPoint;
+}
+
+}
@@ -0,0 +1,196 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+
+#if OPENSIMPLEX_IS_GPU
+    #error "VolumeSampler shouldn't be running on the GPU - so don't try including it!"
+#endif
+
+#include <cmath>
+#include <vector>
+
+#include "Context.h"
+#include "Lattice.h"
+#include "Noise.h"
+
+namespace OpenSimplex
+{
+
+/*
+ * Keeps the gradient buffers of finished VolumeSamplers so that later ones
+ * reuse their memory rather than allocating again. A pool must not be shared
+ * between threads; give each worker thread its own.
+ */
+class GradientPool
+{
+public:
+    inline void acquire(std::vector<float>& buffer);
+    inline void release(std::vector<float>& buffer);
+
+private:
+    std::vector<std::vector<float> > buffers;
+};
+
+/* Hands out the most recently released buffer, if any, by swapping it into buffer. */
+void GradientPool::acquire(std::vector<float>& buffer)
+{
+    if (!buffers.empty()) {
+        buffer.swap(buffers.back());
+        buffers.pop_back();
+    }
+}
+
+void GradientPool::release(std::vector<float>& buffer)
+{
+    buffers.push_back(std::vector<float>());
+    buffers.back().swap(buffer);
+}
+
+/*
+ * Samples 3D noise inside a box whose lattice vertex gradients have been
+ * resolved up front into a VolumeLattice, so that sampling does no hashing
+ * at all. Cover a box, then take any number of samples inside it; fill does
+ * both for a regular volume such as a voxel chunk. The values are identical
+ * to Noise::noise3's. Samples outside the box most recently covered, or
+ * taken before any box was covered, are hashed through the Context instead,
+ * so they are still correct, only slower.
+ *
+ * The sampler keeps its own copy of the context, so it can be built from a
+ * temporary. The pool is only referenced, and must outlive the sampler,
+ * which hands its buffer back on destruction.
+ */
+class VolumeSampler
+{
+public:
+    inline VolumeSampler(const Context& context, GradientPool& pool);
+    inline ~VolumeSampler();
+
+    inline void cover(float minX, float minY, float minZ, float maxX, float maxY, float maxZ);
+    inline float noise3(float x, float y, float z) const;
+    inline void fill(float* out, float originX, float originY, float originZ,
+                     float stepX, float stepY, float stepZ, int width, int height, int depth);
+
+private:
+    VolumeSampler(const VolumeSampler&);
+    VolumeSampler& operator=(const VolumeSampler&);
+
+    Context ctx;
+    GradientPool& pool;
+    std::vector<float> buffer;
+    VolumeLattice lattice;
+    float boxMinX, boxMinY, boxMinZ, boxMaxX, boxMaxY, boxMaxZ;
+};
+
+VolumeSampler::VolumeSampler(const Context& context, GradientPool& gradientPool)
+    : ctx(context), pool(gradientPool), boxMinX(1), boxMinY(1), boxMinZ(1), boxMaxX(0), boxMaxY(0), boxMaxZ(0)
+{
+    pool.acquire(buffer);
+}
+
+VolumeSampler::~VolumeSampler()
+{
+    pool.release(buffer);
+}
+
+/*
+ * Resolves the gradients needed by samples inside the box. Stretching is
+ * linear, so the super-cells of the box are bounded by those of its corners.
+ * Vertices reach from -1 to +2 around a super-cell, and one more on each
+ * side absorbs rounding.
+ */
+void VolumeSampler::cover(float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+{
+    const float stretchConstant = (-1.0f / 6.0f); /* (1 / sqrt(3 + 1) - 1) / 3; */
+
+    int64_t xsbMin = 0, ysbMin = 0, zsbMin = 0, xsbMax = 0, ysbMax = 0, zsbMax = 0;
+    for (int corner = 0; corner < 8; corner++) {
+        float x = (corner & 1) ? maxX : minX;
+        float y = (corner & 2) ? maxY : minY;
+        float z = (corner & 4) ? maxZ : minZ;
+        float stretchOffset = (x + y + z) * stretchConstant;
+        int64_t xsb = (int64_t) std::floor(x + stretchOffset);
+        int64_t ysb = (int64_t) std::floor(y + stretchOffset);
+        int64_t zsb = (int64_t) std::floor(z + stretchOffset);
+        xsbMin = (corner == 0 || xsb < xsbMin) ? xsb : xsbMin;
+        ysbMin = (corner == 0 || ysb < ysbMin) ? ysb : ysbMin;
+        zsbMin = (corner == 0 || zsb < zsbMin) ? zsb : zsbMin;
+        xsbMax = (corner == 0 || xsb > xsbMax) ? xsb : xsbMax;
+        ysbMax = (corner == 0 || ysb > ysbMax) ? ysb : ysbMax;
+        zsbMax = (corner == 0 || zsb > zsbMax) ? zsb : zsbMax;
+    }
+    xsbMin -= 2; ysbMin -= 2; zsbMin -= 2;
+    xsbMax += 3; ysbMax += 3; zsbMax += 3;
+
+    buffer.resize(3 * VolumeLattice::vertexCount(xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax));
+    lattice.cover3(ctx, buffer.data(), xsbMin, ysbMin, zsbMin, xsbMax, ysbMax, zsbMax);
+    boxMinX = minX; boxMinY = minY; boxMinZ = minZ;
+    boxMaxX = maxX; boxMaxY = maxY; boxMaxZ = maxZ;
+}
+
+/* 3D noise at a point, from the covered gradients when it lies inside the box. */
+float VolumeSampler::noise3(float x, float y, float z) const
+{
+    if (x >= boxMinX && x <= boxMaxX && y >= boxMinY && y <= boxMaxY && z >= boxMinZ && z <= boxMaxZ)
+        return Noise::noise3(lattice, x, y, z);
+    return Noise::noise3(ctx, x, y, z);
+}
+
+/*
+ * Covers and fills a width x height x depth volume laid out as
+ * out[(k * height + j) * width + i], sampled at
+ * (originX + i * stepX, originY + j * stepY, originZ + k * stepZ).
+ */
+void VolumeSampler::fill(float* out, float originX, float originY, float originZ,
+                         float stepX, float stepY, float stepZ, int width, int height, int depth)
+{
+    if (width <= 0 || height <= 0 || depth <= 0)
+        return;
+
+    float endX = originX + (width - 1) * stepX;
+    float endY = originY + (height - 1) * stepY;
+    float endZ = originZ + (depth - 1) * stepZ;
+    cover(originX < endX ? originX : endX, originY < endY ? originY : endY, originZ < endZ ? originZ : endZ,
+          originX < endX ? endX : originX, originY < endY ? endY : originY, originZ < endZ ? endZ : originZ);
+
+    for (int k = 0; k < depth; k++) {
+        float z = originZ + k * stepZ;
+        for (int j = 0; j < height; j++) {
+            float y = originY + j * stepY;
+            for (int i = 0; i < width; i++)
+                *out++ = Noise::noise3(lattice, originX + i * stepX, y, z);
+        }
+    }
+}
+
+}
@@ -0,0 +1,176 @@
+/*
+ * OpenSimplex (Simplectic) Noise in portable GPGPU-compatible C++.
+ * Derived from Stephen M. Cameron's C port of Kurt Spencer's Java
+ * implementation by Jonathon Racz.
+ *
+ * This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ *
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+#pragma once
+
+#include "Environment.h"
+#include "Context.h"
+#include "Noise.h"
+
+#if !OPENSIMPLEX_IS_GPU
+    #include <cstddef>
+
+    #include "NoiseBatch.h"
+#endif
+
+namespace OpenSimplex
+{
+
+/*
+ * Domain warping: noise sampled at a point displaced by other noise
+ * fields. Each of iterations rounds moves the point by amplitude times the
+ * noise of the displacement contexts there, one context per axis, and the
+ * result is the noise of context at the final point. For warp2:
+ *
+ *     x += amplitude * noise2(displacement[0], x, y)
+ *     y += amplitude * noise2(displacement[1], x, y)   (both at the old x, y)
+ *
+ * The displacement fields of a round are all sampled at the same point, so
+ * they share one traversal of the lattice through Noise::noise2Seeds and
+ * noise3Seeds. The array forms evaluate each field over a block of points
+ * with NoiseBatch instead, and give the same values as the single point
+ * forms.
+ */
+class Warp
+{
+public:
+    inline explicit Warp(float amplitude = 1.0f, int iterations = 1);
+
+    inline float warp2(OPENSIMPLEX_GPU_CONSTANT const Context& context, OPENSIMPLEX_GPU_CONSTANT const Context* displacement,
+                       float x, float y) const;
+    inline float warp3(OPENSIMPLEX_GPU_CONSTANT const Context& context, OPENSIMPLEX_GPU_CONSTANT const Context* displacement,
+                       float x, float y, float z) const;
+
+#if !OPENSIMPLEX_IS_GPU
+    inline void warp2Batch(const Context& context, const Context* displacement, const float* xs, const float* ys,
+                           float* out, size_t count) const;
+    inline void warp3Batch(const Context& context, const Context* displacement, const float* xs, const float* ys, const float* zs,
+                           float* out, size_t count) const;
+#endif
+
+private:
+    float amplitude;
+    int iterations;
+};
+
+Warp::Warp(float amplitude, int iterations)
+    : amplitude(amplitude), iterations(iterations)
+{
+}
+
+float Warp::warp2(OPENSIMPLEX_GPU_CONSTANT const Context& context, OPENSIMPLEX_GPU_CONSTANT const Context* displacement,
+                  float x, float y) const
+{
+    float offset[2];
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        Noise::noise2Seeds(displacement, 2, x, y, offset);
+        x += amplitude * offset[0];
+        y += amplitude * offset[1];
+    }
+    return Noise::noise2(context, x, y);
+}
+
+float Warp::warp3(OPENSIMPLEX_GPU_CONSTANT const Context& context, OPENSIMPLEX_GPU_CONSTANT const Context* displacement,
+                  float x, float y, float z) const
+{
+    float offset[3];
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        Noise::noise3Seeds(displacement, 3, x, y, z, offset);
+        x += amplitude * offset[0];
+        y += amplitude * offset[1];
+        z += amplitude * offset[2];
+    }
+    return Noise::noise3(context, x, y, z);
+}
+
+#if !OPENSIMPLEX_IS_GPU
+
+/*
+ * The array forms work through the points in blocks, moving the whole block
+ * one round at a time with a NoiseBatch call per displacement field. A
+ * block is copied in before out is written, so out may be one of the input
+ * arrays, but must not overlap them in any other way.
+ */
+void Warp::warp2Batch(const Context& context, const Context* displacement, const float* xs, const float* ys,
+                      float* out, size_t count) const
+{
+    const size_t blockSize = 1024;
+    float warpedX[blockSize], warpedY[blockSize], offsetX[blockSize], offsetY[blockSize];
+
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        for (size_t i = 0; i < n; i++) {
+            warpedX[i] = xs[begin + i];
+            warpedY[i] = ys[begin + i];
+        }
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            NoiseBatch::noise2Batch(displacement[0], warpedX, warpedY, offsetX, n);
+            NoiseBatch::noise2Batch(displacement[1], warpedX, warpedY, offsetY, n);
+            for (size_t i = 0; i < n; i++) {
+                warpedX[i] += amplitude * offsetX[i];
+                warpedY[i] += amplitude * offsetY[i];
+            }
+        }
+        NoiseBatch::noise2Batch(context, warpedX, warpedY, out + begin, n);
+    }
+}
+
+void Warp::warp3Batch(const Context& context, const Context* displacement, const float* xs, const float* ys, const float* zs,
+                      float* out, size_t count) const
+{
+    const size_t blockSize = 1024;
+    float warpedX[blockSize], warpedY[blockSize], warpedZ[blockSize];
+    float offsetX[blockSize], offsetY[blockSize], offsetZ[blockSize];
+
+    for (size_t begin = 0; begin < count; begin += blockSize) {
+        size_t n = count - begin < blockSize ? count - begin : blockSize;
+        for (size_t i = 0; i < n; i++) {
+            warpedX[i] = xs[begin + i];
+            warpedY[i] = ys[begin + i];
+            warpedZ[i] = zs[begin + i];
+        }
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            NoiseBatch::noise3Batch(displacement[0], warpedX, warpedY, warpedZ, offsetX, n);
+            NoiseBatch::noise3Batch(displacement[1], warpedX, warpedY, warpedZ, offsetY, n);
+            NoiseBatch::noise3Batch(displacement[2], warpedX, warpedY, warpedZ, offsetZ, n);
+            for (size_t i = 0; i < n; i++) {
+                warpedX[i] += amplitude * offsetX[i];
+                warpedY[i] += amplitude * offsetY[i];
+                warpedZ[i] += amplitude * offsetZ[i];
+            }
+        }
+        NoiseBatch::noise3Batch(context, warpedX, warpedY, warpedZ, out + begin, n);
+    }
+}
+
+#endif
+
+}
@@ -0,0 +1,852 @@
+/* This is free and unencumbered software released into the public domain.
+ *
+ * Anyone is free to copy, modify, publish, use, compile, sell, or
+ * distribute this software, either in source code form or as a compiled
+ * binary, for any purpose, commercial or non-commercial, and by any
+ * means.
+ * 
+ * In jurisdictions that recognize copyright laws, the author or authors
+ * of this software dedicate any and all copyright interest in the
+ * software to the public domain. We make this dedication for the benefit
+ * of the public at large and to the detriment of our heirs and
+ * successors. We intend this dedication to be an overt act of
+ * relinquishment in perpetuity of all present and future rights to this
+ * software under copyright law.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ * For more information, please refer to <http://unlicense.org>
+ */
+
+/*
+ * Checks the guarantees that are easy to break without noticing: that every
+ * batch kernel the dispatcher can pick, and every sampler that shares work
+ * between samples, gives exactly the scalar results.
+ * Prints each failing check and exits non-zero if any failed; run through
+ * ctest.
+ *
+ * Like the kernels themselves, the checks assume no value-changing floating
+ * point optimizations (-ffast-math, /fp:fast or FMA contraction).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OpenSimplex/OpenSimplex.h"
+#include "OpenSimplex/TileEngine.h"
+
+struct Points
+{
+    std::vector<float> x, y, z, w;
+
+    void add(float px, float py, float pz, float pw)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        w.push_back(pw);
+    }
+
+    size_t size() const { return x.size(); }
+};
+
+static int failures = 0;
+
+static void check(bool passed, const std::string& name)
+{
+    if (!passed) {
+        printf("FAIL %s\n", name.c_str());
+        failures++;
+    }
+}
+
+static bool identical(float a, float b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+/*
+ * Random points near the origin and far from it, points on integer lattice
+ * coordinates and half way between them, where the region tests of the
+ * kernels are decided by ties, and a count that leaves a partial vector.
+ */
+static Points makePoints()
+{
+    Points p;
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> near(-64.0f, 64.0f);
+    std::uniform_real_distribution<float> far(-1.0e6f, 1.0e6f);
+    for (int i = 0; i < 20000; i++)
+        p.add(near(rng), near(rng), near(rng), near(rng));
+    for (int i = 0; i < 20000; i++)
+        p.add(far(rng), far(rng), far(rng), far(rng));
+    std::uniform_int_distribution<int> lattice(-40, 40);
+    for (int i = 0; i < 20000; i++) {
+        float scale = (i & 1) ? 0.5f : 1.0f;
+        p.add(lattice(rng) * scale, lattice(rng) * scale, lattice(rng) * scale, lattice(rng) * scale);
+    }
+    for (float big : { 16777216.0f, -16777216.0f, 1.0e9f, -1.0e9f })
+        p.add(big, -big, big, -big);
+    p.add(0.0f, 0.0f, 0.0f, 0.0f);
+    return p;
+}
+
+/*
+ * The points with every coordinate within limit. Functions that scale their
+ * input, like Fractal, need it to stay inside the int32_t lattice of Noise
+ * after scaling.
+ */
+static Points within(const Points& p, float limit)
+{
+    Points q;
+    for (size_t i = 0; i < p.size(); i++)
+        if (std::fabs(p.x[i]) <= limit && std::fabs(p.y[i]) <= limit && std::fabs(p.z[i]) <= limit && std::fabs(p.w[i]) <= limit)
+            q.add(p.x[i], p.y[i], p.z[i], p.w[i]);
+    return q;
+}
+
+template <typename ContextType>
+static void referenceNoise(const ContextType& ctx, int dims, const Points& p, std::vector<float>& out)
+{
+    out.resize(p.size());
+    for (size_t i = 0; i < p.size(); i++) {
+        if (dims == 2)
+            out[i] = OpenSimplex::Noise::noise2(ctx, p.x[i], p.y[i]);
+        else if (dims == 3)
+            out[i] = OpenSimplex::Noise::noise3(ctx, p.x[i], p.y[i], p.z[i]);
+        else
+            out[i] = OpenSimplex::Noise::noise4(ctx, p.x[i], p.y[i], p.z[i], p.w[i]);
+    }
+}
+
+static bool matches(const std::vector<float>& a, const std::vector<float>& b)
+{
+    for (size_t i = 0; i < a.size(); i++)
+        if (!identical(a[i], b[i]))
+            return false;
+    return true;
+}
+
+#if OPENSIMPLEX_HAS_DISPATCH
+
+static const char* instructionSetName(OpenSimplex::Dispatch::InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+        case OpenSimplex::Dispatch::InstructionSet::SSE2: return "SSE2";
+        case OpenSimplex::Dispatch::InstructionSet::SSE41: return "SSE4.1";
+        case OpenSimplex::Dispatch::InstructionSet::AVX2: return "AVX2";
+        case OpenSimplex::Dispatch::InstructionSet::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+/* Every kernel set up to the one the running CPU supports. */
+static void checkKernels(const OpenSimplex::Context& ctx, const OpenSimplex::HashContext& hashCtx, const Points& p)
+{
+    typedef OpenSimplex::Dispatch::InstructionSet InstructionSet;
+    const InstructionSet sets[] = { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::SSE41,
+                                    InstructionSet::AVX2, InstructionSet::AVX512 };
+    std::vector<float> reference, out(p.size());
+    for (int dims = 2; dims <= 4; dims++) {
+        for (int hashed = 0; hashed < 2; hashed++) {
+            if (hashed)
+                referenceNoise(hashCtx, dims, p, reference);
+            else
+                referenceNoise(ctx, dims, p, reference);
+            for (InstructionSet set : sets) {
+                if (set > OpenSimplex::Dispatch::instructionSet())
+                    break;
+                OpenSimplex::NoiseBatch::Kernels k = OpenSimplex::NoiseBatch::kernelsFor(set);
+                std::fill(out.begin(), out.end(), 0.0f);
+                if (dims == 2 && hashed)
+                    k.noise2Hash(hashCtx, p.x.data(), p.y.data(), out.data(), p.size());
+                else if (dims == 2)
+                    k.noise2(ctx, p.x.data(), p.y.data(), out.data(), p.size());
+                else if (dims == 3 && hashed)
+                    k.noise3Hash(hashCtx, p.x.data(), p.y.data(), p.z.data(), out.data(), p.size());
+                else if (dims == 3)
+                    k.noise3(ctx, p.x.data(), p.y.data(), p.z.data(), out.data(), p.size());
+                else if (hashed)
+                    k.noise4Hash(hashCtx, p.x.data(), p.y.data(), p.z.data(), p.w.data(), out.data(), p.size());
+                else
+                    k.noise4(ctx, p.x.data(), p.y.data(), p.z.data(), p.w.data(), out.data(), p.size());
+                check(matches(out, reference), std::string("noise") + std::to_string(dims) + "Batch " +
+                      (hashed ? "HashContext " : "Context ") + instructionSetName(set));
+            }
+        }
+    }
+}
+
+#endif
+
+/* Whatever kernel the batch calls resolve to. */
+static void checkBatch(const OpenSimplex::Context& ctx, const OpenSimplex::HashContext& hashCtx, const Points& p)
+{
+    std::vector<float> reference, out(p.size());
+    referenceNoise(ctx, 2, p, reference);
+    OpenSimplex::NoiseBatch::noise2Batch(ctx, p.x.data(), p.y.data(), out.data(), p.size());
+    check(matches(out, reference), "noise2Batch Context");
+    referenceNoise(ctx, 3, p, reference);
+    OpenSimplex::NoiseBatch::noise3Batch(ctx, p.x.data(), p.y.data(), p.z.data(), out.data(), p.size());
+    check(matches(out, reference), "noise3Batch Context");
+    referenceNoise(ctx, 4, p, reference);
+    OpenSimplex::NoiseBatch::noise4Batch(ctx, p.x.data(), p.y.data(), p.z.data(), p.w.data(), out.data(), p.size());
+    check(matches(out, reference), "noise4Batch Context");
+    referenceNoise(hashCtx, 2, p, reference);
+    OpenSimplex::NoiseBatch::noise2Batch(hashCtx, p.x.data(), p.y.data(), out.data(), p.size());
+    check(matches(out, reference), "noise2Batch HashContext");
+    referenceNoise(hashCtx, 3, p, reference);
+    OpenSimplex::NoiseBatch::noise3Batch(hashCtx, p.x.data(), p.y.data(), p.z.data(), out.data(), p.size());
+    check(matches(out, reference), "noise3Batch HashContext");
+    referenceNoise(hashCtx, 4, p, reference);
+    OpenSimplex::NoiseBatch::noise4Batch(hashCtx, p.x.data(), p.y.data(), p.z.data(), p.w.data(), out.data(), p.size());
+    check(matches(out, reference), "noise4Batch HashContext");
+}
+
+/*
+ * The seeding functions that are constexpr from C++14 against the runtime
+ * ones. Under C++11 they are plain functions, so only the runtime results
+ * are compared; the sanitizer build compiles this as C++14, which evaluates
+ * them at compile time.
+ */
+static void checkSeeds(const OpenSimplex::Context& ctx, const OpenSimplex::HashContext& hashCtx)
+{
+    OpenSimplex::CompactContext compact;
+    OpenSimplex::Seed::computeCompactContextForSeed(compact, 77374);
+    OpenSimplex::Context fromSeed = OpenSimplex::Seed::contextForSeed(77374);
+    OpenSimplex::CompactContext compacted = OpenSimplex::Seed::compact(fromSeed);
+    OpenSimplex::HashContext hashFromSeed = OpenSimplex::Seed::hashContextForSeed(77374);
+    check(memcmp(&fromSeed, &ctx, sizeof(ctx)) == 0, "contextForSeed");
+    check(memcmp(&compacted, &compact, sizeof(compact)) == 0, "compact");
+    check(hashFromSeed.seed == hashCtx.seed, "hashContextForSeed");
+
+#if (defined(__cplusplus) && __cplusplus >= 201402L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+    static constexpr OpenSimplex::Context compiled = OpenSimplex::Seed::contextForSeed(77374);
+    static constexpr OpenSimplex::CompactContext compiledCompact = OpenSimplex::Seed::compact(compiled);
+    static constexpr OpenSimplex::HashContext compiledHash = OpenSimplex::Seed::hashContextForSeed(77374);
+    check(memcmp(&compiled, &ctx, sizeof(ctx)) == 0, "constexpr contextForSeed");
+    check(memcmp(&compiledCompact, &compact, sizeof(compact)) == 0, "constexpr compact");
+    check(compiledHash.seed == hashCtx.seed, "constexpr hashContextForSeed");
+#endif
+}
+
+/* Noise through a CompactContext against the Context it was made from. */
+static void checkCompact(const OpenSimplex::Context& ctx, const Points& p)
+{
+    OpenSimplex::CompactContext compact = OpenSimplex::Seed::compact(ctx);
+    std::vector<float> reference, out(p.size());
+    for (int dims = 2; dims <= 4; dims++) {
+        referenceNoise(ctx, dims, p, reference);
+        referenceNoise(compact, dims, p, out);
+        check(matches(out, reference), "noise" + std::to_string(dims) + " CompactContext");
+    }
+}
+
+/* noiseNSeeds against noiseN under each of the contexts. */
+static void checkSeedArrays(const OpenSimplex::Context& ctx, const Points& p)
+{
+    OpenSimplex::Context contexts[4] = { ctx, ctx, ctx, ctx };
+    for (int k = 1; k < 4; k++)
+        OpenSimplex::Seed::computeContextForSeed(contexts[k], k);
+    bool passed2 = true, passed3 = true, passed4 = true;
+    for (size_t i = 0; i < p.size(); i++) {
+        float x = p.x[i], y = p.y[i], z = p.z[i], w = p.w[i];
+        float values2[4], values3[4], values4[4];
+        OpenSimplex::Noise::noise2Seeds(contexts, 4, x, y, values2);
+        OpenSimplex::Noise::noise3Seeds(contexts, 4, x, y, z, values3);
+        OpenSimplex::Noise::noise4Seeds(contexts, 4, x, y, z, w, values4);
+        for (int k = 0; k < 4; k++) {
+            passed2 &= identical(values2[k], OpenSimplex::Noise::noise2(contexts[k], x, y));
+            passed3 &= identical(values3[k], OpenSimplex::Noise::noise3(contexts[k], x, y, z));
+            passed4 &= identical(values4[k], OpenSimplex::Noise::noise4(contexts[k], x, y, z, w));
+        }
+    }
+    check(passed2, "noise2Seeds");
+    check(passed3, "noise3Seeds");
+    check(passed4, "noise4Seeds");
+}
+
+/*
+ * noise3Table and noise4Table against noise3 and noise4, through lattices
+ * that keep state of their own per vertex as well as through a Context.
+ */
+static void checkTables(const OpenSimplex::Context& ctx, const Points& p)
+{
+    OpenSimplex::Context contexts[3] = { ctx, ctx, ctx };
+    OpenSimplex::Seed::computeContextForSeed(contexts[1], 1);
+    OpenSimplex::Seed::computeContextForSeed(contexts[2], 2);
+    bool values = true, derivatives = true, seeds = true;
+    for (size_t i = 0; i < p.size(); i++) {
+        float x = p.x[i], y = p.y[i], z = p.z[i], w = p.w[i];
+        values &= identical(OpenSimplex::Noise::noise3Table(ctx, x, y, z), OpenSimplex::Noise::noise3(ctx, x, y, z));
+        values &= identical(OpenSimplex::Noise::noise4Table(ctx, x, y, z, w), OpenSimplex::Noise::noise4(ctx, x, y, z, w));
+
+        OpenSimplex::DerivativeLattice<float> branched(ctx), table(ctx);
+        OpenSimplex::Noise::noise3(branched, x, y, z);
+        OpenSimplex::Noise::noise3Table(table, x, y, z);
+        derivatives &= identical(branched.derivX, table.derivX) && identical(branched.derivY, table.derivY)
+            && identical(branched.derivZ, table.derivZ);
+        OpenSimplex::DerivativeLattice<float> branched4(ctx), table4(ctx);
+        OpenSimplex::Noise::noise4(branched4, x, y, z, w);
+        OpenSimplex::Noise::noise4Table(table4, x, y, z, w);
+        derivatives &= identical(branched4.derivX, table4.derivX) && identical(branched4.derivY, table4.derivY)
+            && identical(branched4.derivZ, table4.derivZ) && identical(branched4.derivW, table4.derivW);
+
+        float branchedSeeds[3] = { 0, 0, 0 }, tableSeeds[3] = { 0, 0, 0 };
+        OpenSimplex::Noise::noise3(OpenSimplex::MultiSeedLattice<float>(contexts, 3, branchedSeeds), x, y, z);
+        OpenSimplex::Noise::noise3Table(OpenSimplex::MultiSeedLattice<float>(contexts, 3, tableSeeds), x, y, z);
+        for (int k = 0; k < 3; k++)
+            seeds &= identical(branchedSeeds[k], tableSeeds[k]);
+    }
+    check(values, "noise3Table/noise4Table Context");
+    check(derivatives, "noise3Table/noise4Table DerivativeLattice");
+    check(seeds, "noise3Table MultiSeedLattice");
+}
+
+/*
+ * The derivative functions: their value is exactly noiseN's, and their
+ * partial derivatives match central differences of DoubleNoise, in double
+ * precision so that the differences are accurate. The vertex selection
+ * makes noise slightly discontinuous in places; an axis where the one-sided
+ * differences disagree straddles such a place and is skipped. The float
+ * derivatives follow the double ones. The points are random, as on lattice
+ * ties float and double may pick different vertices, which changes the
+ * derivatives.
+ */
+static void checkDerivatives(const OpenSimplex::Context& ctx)
+{
+    typedef OpenSimplex::DoubleNoise DoubleNoise;
+    const double h = 1e-6;
+    Points p;
+    std::mt19937 rng(54321);
+    std::uniform_real_distribution<float> near(-64.0f, 64.0f);
+    for (int i = 0; i < 20000; i++)
+        p.add(near(rng), near(rng), near(rng), near(rng));
+    bool values = true, differences = true, precision = true;
+    int checked = 0;
+    for (size_t i = 0; i < p.size(); i++) {
+        float x = p.x[i], y = p.y[i], z = p.z[i], w = p.w[i];
+        OpenSimplex::NoiseDeriv2 float2 = OpenSimplex::Noise::noise2Deriv(ctx, x, y);
+        OpenSimplex::NoiseDeriv3 float3 = OpenSimplex::Noise::noise3Deriv(ctx, x, y, z);
+        OpenSimplex::NoiseDeriv4 float4 = OpenSimplex::Noise::noise4Deriv(ctx, x, y, z, w);
+        values &= identical(float2.value, OpenSimplex::Noise::noise2(ctx, x, y));
+        values &= identical(float3.value, OpenSimplex::Noise::noise3(ctx, x, y, z));
+        values &= identical(float4.value, OpenSimplex::Noise::noise4(ctx, x, y, z, w));
+
+        OpenSimplex::BasicNoiseDeriv2<double> d2 = DoubleNoise::noise2Deriv(ctx, x, y);
+        OpenSimplex::BasicNoiseDeriv3<double> d3 = DoubleNoise::noise3Deriv(ctx, x, y, z);
+        OpenSimplex::BasicNoiseDeriv4<double> d4 = DoubleNoise::noise4Deriv(ctx, x, y, z, w);
+        const double analytic[3][4] = { { d2.dx, d2.dy }, { d3.dx, d3.dy, d3.dz }, { d4.dx, d4.dy, d4.dz, d4.dw } };
+        const float single[3][4] = { { float2.dx, float2.dy }, { float3.dx, float3.dy, float3.dz },
+                                     { float4.dx, float4.dy, float4.dz, float4.dw } };
+        for (int dims = 2; dims <= 4; dims++) {
+            for (int axis = 0; axis < dims; axis++) {
+                double at[3][4];
+                for (int k = 0; k < 3; k++) {
+                    double q[4] = { x, y, z, w };
+                    q[axis] += (k - 1) * h;
+                    at[k][0] = dims == 2 ? DoubleNoise::noise2(ctx, q[0], q[1])
+                             : dims == 3 ? DoubleNoise::noise3(ctx, q[0], q[1], q[2])
+                             : DoubleNoise::noise4(ctx, q[0], q[1], q[2], q[3]);
+                }
+                double backward = (at[1][0] - at[0][0]) / h, forward = (at[2][0] - at[1][0]) / h;
+                precision &= std::fabs(single[dims - 2][axis] - analytic[dims - 2][axis]) <= 1e-4;
+                if (std::fabs(forward - backward) > 1e-3)
+                    continue;
+                differences &= std::fabs((at[2][0] - at[0][0]) / (2 * h) - analytic[dims - 2][axis]) <= 1e-6;
+                checked++;
+            }
+        }
+    }
+    check(values, "noiseNDeriv value equals noiseN");
+    check(differences && checked > (int) p.size() * 8, "noiseNDeriv against central differences");
+    check(precision, "noiseNDeriv float against double");
+}
+
+/* Periodic noise repeats, and ignores periods it cannot wrap into. */
+static void checkPeriodic(const OpenSimplex::Context& ctx)
+{
+    const float s = 0.366025403784439f; /* (sqrt(3) - 1) / 2 */
+    const int periodX = 5, periodY = 7;
+    bool passed = true;
+    for (int k = 0; k < 1000; k++) {
+        float x = k * 0.173f - 40.0f, y = k * 0.089f - 25.0f;
+        float value = OpenSimplex::DoubleNoise::noise2Periodic(ctx, periodX, periodY, (double) x, (double) y);
+        float shifted = OpenSimplex::DoubleNoise::noise2Periodic(ctx, periodX, periodY,
+                                                                 x + periodX * (1 + (double) s) + periodY * (double) s,
+                                                                 y + periodX * (double) s + periodY * (1 + (double) s));
+        passed &= std::fabs(value - shifted) < 1e-5f;
+    }
+    check(passed, "noise2Periodic repeats");
+    check(OpenSimplex::Noise::noise2Periodic(ctx, 0, -3, 1.3f, 2.6f) == OpenSimplex::Noise::noise2Periodic(ctx, 1, 1, 1.3f, 2.6f),
+          "noise2Periodic with periods below 1");
+}
+
+/* AnimatedField frames against noise3 at their time, split into ranges as threads would. */
+static void checkAnimatedField(const OpenSimplex::Context& ctx, const OpenSimplex::HashContext& hashCtx, const Points& p)
+{
+    OpenSimplex::AnimatedField field(ctx, p.x.data(), p.y.data(), p.size());
+    OpenSimplex::HashAnimatedField hashField(hashCtx, p.x.data(), p.y.data(), p.size());
+    std::vector<float> out(p.size()), hashOut(p.size());
+    bool passed = true, hashPassed = true;
+    for (int frame = 0; frame < 3; frame++) {
+        float time = 10.0f + frame * (1.0f / 60);
+        size_t middle = p.size() / 3;
+        field.evaluate(time, out.data(), 0, middle);
+        field.evaluate(time, out.data(), middle, p.size());
+        field.evaluate(time, out.data(), p.size(), p.size());
+        hashField.evaluate(time, hashOut.data());
+        for (size_t i = 0; i < p.size(); i++) {
+            passed &= identical(out[i], OpenSimplex::Noise::noise3(ctx, p.x[i], p.y[i], time));
+            hashPassed &= identical(hashOut[i], OpenSimplex::Noise::noise3(hashCtx, p.x[i], p.y[i], time));
+        }
+    }
+    check(passed, "AnimatedField");
+    check(hashPassed, "HashAnimatedField");
+}
+
+/* StridedBatch over interleaved points, through indices with repeats as well as in order. */
+static void checkStrided(const OpenSimplex::Context& ctx, const Points& p)
+{
+    const size_t stride = 5;
+    std::vector<float> points(p.size() * stride), out(p.size() * stride, 0.0f);
+    for (size_t i = 0; i < p.size(); i++) {
+        points[i * stride] = p.x[i];
+        points[i * stride + 1] = p.y[i];
+        points[i * stride + 2] = p.z[i];
+    }
+    OpenSimplex::StridedBatch::noise3(ctx, points.data(), stride, p.size(), out.data() + 4, stride);
+    bool passed = true;
+    for (size_t i = 0; i < p.size(); i++)
+        passed &= identical(out[i * stride + 4], OpenSimplex::Noise::noise3(ctx, p.x[i], p.y[i], p.z[i]));
+    check(passed, "StridedBatch noise3");
+
+    std::vector<uint32_t> indices;
+    for (size_t i = 0; i < p.size(); i += 7)
+        indices.push_back((uint32_t) i);
+    indices.push_back(0);
+    indices.push_back(7);
+    std::vector<float> picked(p.size(), 0.0f);
+    OpenSimplex::StridedBatch::noise2(ctx, points.data(), stride, indices.size(), picked.data(), 1, indices.data());
+    passed = true;
+    for (size_t i = 0; i < p.size(); i++)
+        passed &= identical(picked[i], i % 7 ? 0.0f : OpenSimplex::Noise::noise2(ctx, p.x[i], p.y[i]));
+    check(passed, "StridedBatch noise2 with indices");
+}
+
+/*
+ * Fractal and Warp array forms against their single point forms, writing
+ * over one of their inputs, which they allow. The points are kept within
+ * 1e6, so the highest octave stays well inside the lattice.
+ */
+static void checkInPlace(const OpenSimplex::Context& ctx, const Points& all)
+{
+    Points p = within(all, 1.0e6f);
+    OpenSimplex::Context displacement[3] = { ctx, ctx, ctx };
+    OpenSimplex::Seed::computeContextForSeed(displacement[0], 1);
+    OpenSimplex::Seed::computeContextForSeed(displacement[1], 2);
+    OpenSimplex::Seed::computeContextForSeed(displacement[2], 3);
+    OpenSimplex::Fractal<4, 3> fractal(0.5f);
+    OpenSimplex::Warp warp(0.5f, 2);
+
+    std::vector<float> xs = p.x;
+    fractal.noiseBatch(ctx, xs.data(), p.y.data(), p.z.data(), xs.data(), xs.size());
+    bool passed = true;
+    for (size_t i = 0; i < p.size(); i++)
+        passed &= identical(xs[i], fractal.noise(ctx, p.x[i], p.y[i], p.z[i]));
+    check(passed, "Fractal noiseBatch in place");
+
+    std::vector<float> ys = p.y;
+    warp.warp2Batch(ctx, displacement, p.x.data(), ys.data(), ys.data(), ys.size());
+    passed = true;
+    for (size_t i = 0; i < p.size(); i++)
+        passed &= identical(ys[i], warp.warp2(ctx, displacement, p.x[i], p.y[i]));
+    check(passed, "Warp warp2Batch in place");
+}
+
+/*
+ * FixedNoise against float noise2/3 near the origin and DoubleNoise over
+ * the whole int32_t input range, within the documented 1e-3. It promises
+ * the same results on every machine, so checksums of them over random
+ * inputs and over the corners of the input range are also pinned here.
+ */
+static void checkFixed(const OpenSimplex::Context& ctx)
+{
+    const double tolerance = 1e-3;
+    const double one = OpenSimplex::FixedNoise::one;
+    std::mt19937 rng(12345);
+    uint64_t hash = 1469598103934665603ull;
+    double floatError = 0, doubleError = 0;
+    for (int i = 0; i < 100000; i++) {
+        int32_t x = (int32_t) rng(), y = (int32_t) rng(), z = (int32_t) rng();
+        int32_t fixed2 = OpenSimplex::FixedNoise::noise2(ctx, x, y);
+        int32_t fixed3 = OpenSimplex::FixedNoise::noise3(ctx, x, y, z);
+        hash = (hash ^ (uint32_t) fixed2) * 1099511628211ull;
+        hash = (hash ^ (uint32_t) fixed3) * 1099511628211ull;
+        doubleError = std::max(doubleError, std::fabs(fixed2 / one - OpenSimplex::DoubleNoise::noise2(ctx, x / one, y / one)));
+        doubleError = std::max(doubleError, std::fabs(fixed3 / one - OpenSimplex::DoubleNoise::noise3(ctx, x / one, y / one, z / one)));
+
+        int32_t nearX = x % (64 * OpenSimplex::FixedNoise::one), nearY = y % (64 * OpenSimplex::FixedNoise::one);
+        int32_t nearZ = z % (64 * OpenSimplex::FixedNoise::one);
+        float fx = (float) (nearX / one), fy = (float) (nearY / one), fz = (float) (nearZ / one);
+        floatError = std::max(floatError, std::fabs(OpenSimplex::FixedNoise::noise2(ctx, nearX, nearY) / one - OpenSimplex::Noise::noise2(ctx, fx, fy)));
+        floatError = std::max(floatError, std::fabs(OpenSimplex::FixedNoise::noise3(ctx, nearX, nearY, nearZ) / one
+                                                    - OpenSimplex::Noise::noise3(ctx, fx, fy, fz)));
+    }
+    check(hash == 0x7987e330be258820ull, "FixedNoise checksum");
+    check(floatError <= tolerance, "FixedNoise follows Noise (max error " + std::to_string(floatError) + ")");
+    check(doubleError <= tolerance, "FixedNoise follows DoubleNoise (max error " + std::to_string(doubleError) + ")");
+
+    const int32_t limits[] = { INT32_MIN, INT32_MIN + 1, -1, 0, 1, INT32_MAX - 1, INT32_MAX };
+    uint64_t limitHash = 1469598103934665603ull;
+    double limitError = 0;
+    for (int32_t x : limits) {
+        for (int32_t y : limits) {
+            int32_t fixed2 = OpenSimplex::FixedNoise::noise2(ctx, x, y);
+            limitHash = (limitHash ^ (uint32_t) fixed2) * 1099511628211ull;
+            limitError = std::max(limitError, std::fabs(fixed2 / one - OpenSimplex::DoubleNoise::noise2(ctx, x / one, y / one)));
+            for (int32_t z : limits) {
+                int32_t fixed3 = OpenSimplex::FixedNoise::noise3(ctx, x, y, z);
+                limitHash = (limitHash ^ (uint32_t) fixed3) * 1099511628211ull;
+                limitError = std::max(limitError, std::fabs(fixed3 / one - OpenSimplex::DoubleNoise::noise3(ctx, x / one, y / one, z / one)));
+            }
+        }
+    }
+    check(limitHash == 0x4207ad690e0c51fcull, "FixedNoise checksum at the range limits");
+    check(limitError <= tolerance, "FixedNoise at the range limits (max error " + std::to_string(limitError) + ")");
+}
+
+/* Quantizer rounding against lround, over the noise range. */
+static void checkQuantize()
+{
+    OpenSimplex::Quantizer<uint8_t> quantizer8;
+    OpenSimplex::Quantizer<uint16_t> quantizer16;
+    OpenSimplex::Quantizer<int16_t> quantizerSigned;
+    bool passed8 = true, passed16 = true, passedSigned = true;
+    const int steps = 2000000;
+    for (int k = 0; k <= steps; k++) {
+        float x = -1 + 2.0f * k / steps;
+        passed8 &= quantizer8(x, 0, 0) == std::lround(x * 127.5f + 127.5f);
+        passed16 &= quantizer16(x, 0, 0) == std::lround(x * 32767.5f + 32767.5f);
+        passedSigned &= quantizerSigned(x, 0, 0) == std::lround(x * 32767.0f);
+    }
+    check(passed8, "Quantizer<uint8_t> rounding");
+    check(passed16, "Quantizer<uint16_t> rounding");
+    check(passedSigned, "Quantizer<int16_t> rounding");
+    check(OpenSimplex::Quantizer<uint8_t>(0.5f, 0.5f)(0.9f, 0, 0) == 128, "Quantizer with an empty range");
+}
+
+/* The exact value of a half precision bit pattern. */
+static float halfValue(uint16_t bits)
+{
+    int exponent = bits >> 10 & 0x1F, mantissa = bits & 0x3FF;
+    float magnitude = exponent ? std::ldexp((float) (mantissa | 0x400), exponent - 25) : std::ldexp((float) mantissa, -24);
+    return (bits & 0x8000) ? -magnitude : magnitude;
+}
+
+/*
+ * Whether half is x rounded to the nearest half, ties to even: no neighbour
+ * of it is nearer, and on a tie it is the even one.
+ */
+static bool roundsToNearest(float x, uint16_t half)
+{
+    double error = std::fabs((double) halfValue(half) - x);
+    for (int neighbour = -1; neighbour <= 1; neighbour += 2) {
+        uint16_t other = (uint16_t) (half + neighbour);
+        if ((other & 0x7FFF) > 0x3C00 || (other & 0x8000) != (half & 0x8000))
+            continue;
+        double otherError = std::fabs((double) halfValue(other) - x);
+        if (otherError < error || (otherError == error && (half & 1)))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Half conversion at the edges of its range and of the subnormals, and at
+ * ties, including ones that round up into the next exponent; then a sweep
+ * of float bit patterns over [-1, 1] against round to nearest even.
+ */
+static void checkHalf()
+{
+    struct Case { float x; uint16_t bits; };
+    const Case cases[] = {
+        { 0.0f, 0x0000 }, { -0.0f, 0x8000 }, { 1.0f, 0x3C00 }, { -1.0f, 0xBC00 }, { 2.0f, 0x3C00 }, { -3.0f, 0xBC00 },
+        { std::ldexp(1.0f, -24), 0x0001 },             /* Smallest subnormal. */
+        { std::ldexp(1.0f, -25), 0x0000 },             /* Tie with zero, to even. */
+        { std::ldexp(1.0f, -25) * 1.0001f, 0x0001 },
+        { std::ldexp(3.0f, -25), 0x0002 },             /* Tie between 1 and 2, to even. */
+        { std::ldexp(1023.0f, -24), 0x03FF },          /* Largest subnormal. */
+        { std::ldexp(2047.0f, -25), 0x0400 },          /* Tie rounding up to the smallest normal. */
+        { std::ldexp(1.0f, -14), 0x0400 },
+        { 0.5f - std::ldexp(1.0f, -13), 0x3800 },      /* Tie rounding up across an exponent. */
+        { 1.0f - std::ldexp(1.0f, -12), 0x3C00 },      /* Tie rounding up to 1. */
+        { 1.0f - std::ldexp(1.0f, -11), 0x3BFF },
+        { -(1.0f - std::ldexp(1.0f, -12)), 0xBC00 },
+    };
+    bool edges = true;
+    for (const Case& c : cases)
+        edges &= OpenSimplex::QuantizeFormat<OpenSimplex::Half>::convert(c.x).bits == c.bits;
+    check(edges, "Half conversion at edge values");
+
+    bool nearest = true;
+    for (uint32_t bits = 0; bits <= 0x3F800000u; bits += 61) {
+        for (uint32_t sign = 0; sign < 2; sign++) {
+            uint32_t pattern = bits | sign << 31;
+            float x;
+            memcpy(&x, &pattern, sizeof(x));
+            nearest &= roundsToNearest(x, OpenSimplex::QuantizeFormat<OpenSimplex::Half>::convert(x).bits);
+        }
+    }
+    check(nearest, "Half conversion rounds to nearest even");
+}
+
+/*
+ * Dithering moves a value by less than half a step, so every sample rounds
+ * to one of the two integers around it, and a 4x4 tile averages to within a
+ * sixteenth of a step of the undithered value.
+ */
+static void checkDither()
+{
+    OpenSimplex::Quantizer<uint8_t> quantizer(-1, 1, true);
+    bool bounded = true, averaged = true;
+    for (int k = 0; k <= 100000; k++) {
+        float value = -1 + 2.0f * k / 100000;
+        float x = value * 127.5f + 127.5f;
+        int sum = 0;
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+                int q = quantizer(value, i, j);
+                bounded &= q >= std::floor(x) && q <= std::ceil(x);
+                sum += q;
+            }
+        }
+        if (x >= 0.5f && x <= 254.5f)
+            averaged &= std::fabs(sum / 16.0f - x) <= 1.0f / 16;
+    }
+    check(bounded, "Quantizer dither within half a step");
+    check(averaged, "Quantizer dither averages to the value");
+}
+
+template <typename Out>
+static bool sameBits(const Out& a, const Out& b)
+{
+    return memcmp(&a, &b, sizeof(Out)) == 0;
+}
+
+/* The fused grid and batch functions against quantizing noise2/3/4 point by point. */
+template <typename Out>
+static void checkFusedQuantize(const OpenSimplex::Context& ctx, const Points& p, const OpenSimplex::Quantizer<Out>& quantizer,
+                               const std::string& name)
+{
+    const int width = 70, height = 40, depth = 5;
+    const float originX = -3.7f, originY = 11.2f, originZ = 0.3f, step = 0.043f;
+    std::vector<Out> out((size_t) width * height * depth);
+
+    bool passed = true;
+    OpenSimplex::Quantize::fillGrid2(ctx, out.data(), quantizer, originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= sameBits(out[(size_t) j * width + i], quantizer(OpenSimplex::Noise::noise2(ctx, originX + i * step, originY + j * step), i, j));
+    check(passed, "Quantize fillGrid2 " + name);
+
+    passed = true;
+    OpenSimplex::Quantize::fillGrid3(ctx, out.data(), quantizer, originX, originY, originZ, step, step, step, width, height, depth);
+    for (int k = 0; k < depth; k++)
+        for (int j = 0; j < height; j++)
+            for (int i = 0; i < width; i++)
+                passed &= sameBits(out[((size_t) k * height + j) * width + i],
+                                   quantizer(OpenSimplex::Noise::noise3(ctx, originX + i * step, originY + j * step, originZ + k * step), i, j));
+    check(passed, "Quantize fillGrid3 " + name);
+
+    std::vector<Out> batch2(p.size()), batch3(p.size()), batch4(p.size());
+    OpenSimplex::Quantize::noise2Batch(ctx, p.x.data(), p.y.data(), batch2.data(), p.size(), quantizer);
+    OpenSimplex::Quantize::noise3Batch(ctx, p.x.data(), p.y.data(), p.z.data(), batch3.data(), p.size(), quantizer);
+    OpenSimplex::Quantize::noise4Batch(ctx, p.x.data(), p.y.data(), p.z.data(), p.w.data(), batch4.data(), p.size(), quantizer);
+    passed = true;
+    for (size_t n = 0; n < p.size(); n++) {
+        int i = (int) (n & 3), j = (int) (n >> 2 & 3);
+        passed &= sameBits(batch2[n], quantizer(OpenSimplex::Noise::noise2(ctx, p.x[n], p.y[n]), i, j));
+        passed &= sameBits(batch3[n], quantizer(OpenSimplex::Noise::noise3(ctx, p.x[n], p.y[n], p.z[n]), i, j));
+        passed &= sameBits(batch4[n], quantizer(OpenSimplex::Noise::noise4(ctx, p.x[n], p.y[n], p.z[n], p.w[n]), i, j));
+    }
+    check(passed, "Quantize noiseNBatch " + name);
+}
+
+/*
+ * fillGrid2/3, VolumeSampler and the slices against noise2/3/4, including
+ * samples outside the covered box of the sampler.
+ */
+static void checkRasters(const OpenSimplex::Context& ctx, const OpenSimplex::HashContext& hashCtx)
+{
+    const int width = 70, height = 40, depth = 5;
+    const float originX = -3.7f, originY = 11.2f, originZ = 0.3f, step = 0.043f;
+    std::vector<float> out((size_t) width * height * depth);
+    bool passed = true;
+
+    OpenSimplex::Noise::fillGrid2(ctx, out.data(), originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= identical(out[(size_t) j * width + i], OpenSimplex::Noise::noise2(ctx, originX + i * step, originY + j * step));
+    check(passed, "fillGrid2");
+
+    passed = true;
+    OpenSimplex::Noise::fillGrid3(ctx, out.data(), originX, originY, originZ, step, step, step, width, height, depth);
+    for (int k = 0; k < depth; k++)
+        for (int j = 0; j < height; j++)
+            for (int i = 0; i < width; i++)
+                passed &= identical(out[((size_t) k * height + j) * width + i],
+                                    OpenSimplex::Noise::noise3(ctx, originX + i * step, originY + j * step, originZ + k * step));
+    check(passed, "fillGrid3");
+
+    OpenSimplex::GradientPool pool;
+    OpenSimplex::VolumeSampler sampler(ctx, pool);
+    check(identical(sampler.noise3(1.5f, -2.25f, 7.0f), OpenSimplex::Noise::noise3(ctx, 1.5f, -2.25f, 7.0f)), "VolumeSampler before cover");
+
+    passed = true;
+    sampler.fill(out.data(), originX, originY, originZ, step, step, step, width, height, depth);
+    for (int k = 0; k < depth; k++)
+        for (int j = 0; j < height; j++)
+            for (int i = 0; i < width; i++)
+                passed &= identical(out[((size_t) k * height + j) * width + i],
+                                    OpenSimplex::Noise::noise3(ctx, originX + i * step, originY + j * step, originZ + k * step));
+    check(passed, "VolumeSampler fill");
+    check(identical(sampler.noise3(100.5f, -2.25f, 7.0f), OpenSimplex::Noise::noise3(ctx, 100.5f, -2.25f, 7.0f)), "VolumeSampler outside the box");
+
+    OpenSimplex::VolumeSampler temporarySampler(OpenSimplex::Seed::contextForSeed(5), pool);
+    temporarySampler.cover(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+    check(identical(temporarySampler.noise3(0.5f, 0.25f, 0.75f), OpenSimplex::Noise::noise3(OpenSimplex::Seed::contextForSeed(5), 0.5f, 0.25f, 0.75f)),
+          "VolumeSampler from a temporary context");
+
+    passed = true;
+    OpenSimplex::Slice3 slice3(ctx, originZ);
+    slice3.fill(out.data(), originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= identical(out[(size_t) j * width + i], OpenSimplex::Noise::noise3(ctx, originX + i * step, originY + j * step, originZ));
+    check(passed, "Slice3 fill");
+
+    passed = true;
+    OpenSimplex::Slice4 slice4(ctx, originZ, -originZ);
+    slice4.fill(out.data(), originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= identical(out[(size_t) j * width + i], OpenSimplex::Noise::noise4(ctx, originX + i * step, originY + j * step, originZ, -originZ));
+    check(passed, "Slice4 fill");
+
+    /* Slices keep their own context, so one built from a temporary is fine. */
+    passed = true;
+    OpenSimplex::Slice3 temporary(OpenSimplex::Seed::contextForSeed(5), originZ);
+    OpenSimplex::Context seed5 = OpenSimplex::Seed::contextForSeed(5);
+    temporary.fill(out.data(), originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= identical(out[(size_t) j * width + i], OpenSimplex::Noise::noise3(seed5, originX + i * step, originY + j * step, originZ));
+    check(passed, "Slice3 from a temporary context");
+
+    passed = true;
+    OpenSimplex::HashSlice4 hashSlice4(hashCtx, originZ, -originZ);
+    hashSlice4.fill(out.data(), originX, originY, step, step, width, height);
+    for (int j = 0; j < height; j++)
+        for (int i = 0; i < width; i++)
+            passed &= identical(out[(size_t) j * width + i], OpenSimplex::Noise::noise4(hashCtx, originX + i * step, originY + j * step, originZ, -originZ));
+    check(passed, "HashSlice4 fill");
+}
+
+/*
+ * TileEngine with one, two, five and the default number of threads:
+ * parallelFor runs every task once and passes on exceptions, and the tiled
+ * fills match fillGrid2/3.
+ */
+static void checkTileEngine(const OpenSimplex::Context& ctx)
+{
+    const int width = 300, height = 70, depth = 9;
+    const float originX = -3.7f, originY = 11.2f, originZ = 0.3f, step = 0.043f;
+    std::vector<float> reference2((size_t) width * height), reference3((size_t) width * height * depth);
+    OpenSimplex::Noise::fillGrid2(ctx, reference2.data(), originX, originY, step, step, width, height);
+    OpenSimplex::Noise::fillGrid3(ctx, reference3.data(), originX, originY, originZ, step, step, step, width, height, depth);
+
+    for (unsigned threads : { 1u, 2u, 5u, 0u }) {
+        OpenSimplex::TileEngine engine(threads);
+        std::string name = "TileEngine with " + std::to_string(engine.threadCount()) + " threads ";
+
+        const int taskCount = 1000;
+        std::vector<std::atomic<int> > runs(taskCount);
+        for (int task = 0; task < taskCount; task++)
+            runs[task] = 0;
+        engine.parallelFor(taskCount, [&](int task) { runs[task]++; });
+        bool once = true;
+        for (int task = 0; task < taskCount; task++)
+            once &= runs[task] == 1;
+        check(once, name + "parallelFor runs every task once");
+
+        bool caught = false;
+        try {
+            engine.parallelFor(taskCount, [](int task) {
+                if (task % 100 == 37)
+                    throw std::runtime_error("task failed");
+            });
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        check(caught, name + "parallelFor rethrows");
+
+        std::vector<float> out2((size_t) width * height), out3((size_t) width * height * depth);
+        engine.fill2(ctx, out2.data(), originX, originY, step, step, width, height);
+        engine.fill3(ctx, out3.data(), originX, originY, originZ, step, step, step, width, height, depth);
+        check(matches(out2, reference2), name + "fill2");
+        check(matches(out3, reference3), name + "fill3");
+    }
+}
+
+int main()
+{
+    OpenSimplex::Context context;
+    OpenSimplex::HashContext hashContext;
+    OpenSimplex::Seed::computeContextForSeed(context, 77374);
+    OpenSimplex::Seed::computeHashContextForSeed(hashContext, 77374);
+    Points points = makePoints();
+
+#if OPENSIMPLEX_HAS_DISPATCH
+    checkKernels(context, hashContext, points);
+#endif
+    checkSeeds(context, hashContext);
+    checkBatch(context, hashContext, points);
+    checkCompact(context, points);
+    checkSeedArrays(context, points);
+    checkTables(context, points);
+    checkDerivatives(context);
+    checkPeriodic(context);
+    checkAnimatedField(context, hashContext, points);
+    checkStrided(context, points);
+    checkInPlace(context, points);
+    checkFixed(context);
+    checkQuantize();
+    checkHalf();
+    checkDither();
+    checkFusedQuantize(context, points, OpenSimplex::Quantizer<uint8_t>(-1, 1, true), "uint8_t dithered");
+    checkFusedQuantize(context, points, OpenSimplex::Quantizer<uint16_t>(-0.5f, 0.7f), "uint16_t");
+    checkFusedQuantize(context, points, OpenSimplex::Quantizer<int16_t>(), "int16_t");
+    checkFusedQuantize(context, points, OpenSimplex::Quantizer<OpenSimplex::Half>(), "Half");
+    checkRasters(context, hashContext);
+    checkTileEngine(context);
+
+    if (failures)
+        printf("%d checks failed\n", failures);
+    else
+        printf("All checks passed\n");
+    return failures ? 1 : 0;
+}